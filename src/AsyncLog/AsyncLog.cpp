@@ -0,0 +1,422 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "AsyncLog.h"
+
+#include <yarp/os/Log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    using LogType = yarp::os::Log::LogType;
+    using LogCallback = yarp::os::Log::LogCallback;
+
+    // The file, function and component names are string literals, only the
+    // message has to be copied
+    struct Record
+    {
+        LogType type = LogType::LogTypeUnknown;
+        const char* file = nullptr;
+        unsigned int line = 0;
+        const char* function = nullptr;
+        double systemTime = 0.0;
+        double networkTime = 0.0;
+        double externalTime = 0.0;
+        const char* component = nullptr;
+    };
+
+    // The sequence tells who owns the slot: the producer that reserved the
+    // position equal to it, or the writer once it is one past the position
+    struct Slot
+    {
+        std::atomic<size_t> sequence{0};
+        Record record;
+    };
+
+    constexpr auto WriterPeriod = std::chrono::milliseconds(1);
+    constexpr auto FatalFlushTimeout = std::chrono::milliseconds(100);
+
+    const char* LevelName(const LogType type)
+    {
+        switch (type) {
+            case LogType::TraceType:
+                return "TRACE";
+            case LogType::DebugType:
+                return "DEBUG";
+            case LogType::InfoType:
+                return "INFO";
+            case LogType::WarningType:
+                return "WARNING";
+            case LogType::ErrorType:
+                return "ERROR";
+            case LogType::FatalType:
+                return "FATAL";
+            default:
+                return "LOG";
+        }
+    }
+
+    void Callback(LogType type,
+                  const char* message,
+                  const char* file,
+                  const unsigned int line,
+                  const char* function,
+                  double systemTime,
+                  double networkTime,
+                  double externalTime,
+                  const char* component);
+
+    // Bounded multi-producer single-consumer ring, with the messages stored
+    // in a preallocated buffer
+    class Sink
+    {
+    public:
+        std::mutex installMutex;
+        unsigned references = 0;
+
+        std::atomic<LogCallback> previous{nullptr};
+        std::atomic<bool> accepting{false};
+        std::atomic<int> producers{0};
+        std::atomic<uint64_t> dropped{0};
+
+        std::unique_ptr<Slot[]> slots;
+        std::vector<char> messages;
+        size_t capacity = 0;
+        size_t messageSize = 0;
+        std::atomic<size_t> tail{0};
+        std::atomic<size_t> head{0};
+
+        std::FILE* file = nullptr;
+        std::thread writer;
+        std::atomic<bool> stopWriter{false};
+
+        ~Sink()
+        {
+            // The process exits without uninstalling the sink
+            if (writer.joinable()) {
+                stop();
+            }
+        }
+
+        bool start(const openvr_log::AsyncLogOptions& options)
+        {
+            const size_t requested = std::min(
+                options.capacity, openvr_log::AsyncLogOptions::MaxCapacity);
+            capacity = 1;
+            while (capacity < requested) {
+                capacity <<= 1;
+            }
+            messageSize = std::max<size_t>(options.maxMessageLength, 16) + 1;
+
+            if (!options.file.empty()) {
+                file = std::fopen(options.file.c_str(), "a");
+                if (!file) {
+                    return false;
+                }
+            }
+
+            slots = std::make_unique<Slot[]>(capacity);
+            for (size_t i = 0; i < capacity; ++i) {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            messages.assign(capacity * messageSize, '\0');
+            tail.store(0, std::memory_order_relaxed);
+            head.store(0, std::memory_order_relaxed);
+            dropped = 0;
+
+            // If the callback is still ours, a previous sink could not
+            // restore it and its target is kept
+            const LogCallback current = yarp::os::Log::printCallback();
+            if (current != Callback) {
+                previous = current;
+            }
+
+            stopWriter = false;
+            writer = std::thread([this] { writeLoop(); });
+            accepting = true;
+            yarp::os::Log::setPrintCallback(Callback);
+
+            return true;
+        }
+
+        void stop()
+        {
+            accepting = false;
+
+            // Someone else replaced the callback after us: it stays installed
+            // and forwards the records synchronously
+            if (yarp::os::Log::printCallback() == Callback) {
+                yarp::os::Log::setPrintCallback(previous);
+            }
+
+            stopWriter = true;
+            writer.join();
+
+            if (file) {
+                std::fclose(file);
+                file = nullptr;
+            }
+        }
+
+        bool push(const Record& record, const char* message)
+        {
+            size_t position = tail.load(std::memory_order_relaxed);
+            Slot* slot = nullptr;
+
+            while (true) {
+                slot = &slots[position & (capacity - 1)];
+                const size_t sequence =
+                    slot->sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::ptrdiff_t>(sequence)
+                                        - static_cast<std::ptrdiff_t>(position);
+
+                if (difference == 0) {
+                    if (tail.compare_exchange_weak(
+                            position,
+                            position + 1,
+                            std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (difference < 0) {
+                    // Full, the record is dropped rather than waiting
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                else {
+                    position = tail.load(std::memory_order_relaxed);
+                }
+            }
+
+            slot->record = record;
+            char* buffer = messageOf(position);
+            message = message ? message : "";
+            const size_t length = strnlen(message, messageSize);
+            if (length < messageSize) {
+                std::memcpy(buffer, message, length);
+                buffer[length] = '\0';
+            }
+            else {
+                std::memcpy(buffer, message, messageSize - 4);
+                std::memcpy(buffer + messageSize - 4, "...", 4);
+            }
+
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Only called by the writer thread
+        size_t drain()
+        {
+            size_t written = 0;
+            size_t position = head.load(std::memory_order_relaxed);
+
+            while (true) {
+                Slot& slot = slots[position & (capacity - 1)];
+                if (slot.sequence.load(std::memory_order_acquire)
+                    != position + 1) {
+                    break;
+                }
+
+                write(slot.record, messageOf(position));
+                slot.sequence.store(position + capacity,
+                                    std::memory_order_release);
+                head.store(++position, std::memory_order_release);
+                written++;
+            }
+
+            return written;
+        }
+
+        // All the reserved positions have been written
+        bool empty() const
+        {
+            return head.load(std::memory_order_acquire)
+                   == tail.load(std::memory_order_acquire);
+        }
+
+        void write(const Record& record, const char* message) const
+        {
+            if (file) {
+                std::fprintf(file,
+                             "[%.6f] [%s]%s%s%s %s\n",
+                             record.systemTime,
+                             LevelName(record.type),
+                             record.component ? " [" : "",
+                             record.component ? record.component : "",
+                             record.component ? "]" : "",
+                             message);
+                return;
+            }
+
+            if (const LogCallback callback = previous) {
+                callback(record.type,
+                         message,
+                         record.file,
+                         record.line,
+                         record.function,
+                         record.systemTime,
+                         record.networkTime,
+                         record.externalTime,
+                         record.component);
+            }
+        }
+
+        void writeLoop()
+        {
+            uint64_t reported = 0;
+
+            while (true) {
+                const bool stopping = stopWriter;
+                const size_t written = drain();
+
+                const uint64_t lost = dropped.load(std::memory_order_relaxed);
+                if (lost > reported) {
+                    const std::string message =
+                        std::to_string(lost - reported)
+                        + " log records dropped, the queue was full";
+                    Record record;
+                    record.type = LogType::WarningType;
+                    record.systemTime =
+                        std::chrono::duration<double>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+                    write(record, message.c_str());
+                    reported = lost;
+                }
+
+                if (written > 0) {
+                    if (file) {
+                        std::fflush(file);
+                    }
+                    continue;
+                }
+
+                // The producers that passed the check on accepting before the
+                // stop still have to be written
+                if (stopping && producers == 0 && empty()) {
+                    break;
+                }
+                std::this_thread::sleep_for(WriterPeriod);
+            }
+        }
+
+    private:
+        char* messageOf(const size_t position)
+        {
+            return messages.data() + (position & (capacity - 1)) * messageSize;
+        }
+    };
+
+    Sink& Instance()
+    {
+        static Sink sink;
+        return sink;
+    }
+
+    void Callback(LogType type,
+                  const char* message,
+                  const char* file,
+                  const unsigned int line,
+                  const char* function,
+                  double systemTime,
+                  double networkTime,
+                  double externalTime,
+                  const char* component)
+    {
+        Sink& sink = Instance();
+        const Record record = {type,
+                               file,
+                               line,
+                               function,
+                               systemTime,
+                               networkTime,
+                               externalTime,
+                               component};
+
+        sink.producers.fetch_add(1, std::memory_order_acq_rel);
+
+        if (!sink.accepting) {
+            sink.producers.fetch_sub(1, std::memory_order_release);
+            if (const LogCallback previous = sink.previous) {
+                previous(type,
+                         message,
+                         file,
+                         line,
+                         function,
+                         systemTime,
+                         networkTime,
+                         externalTime,
+                         component);
+            }
+            return;
+        }
+
+        // The process terminates after a fatal record: it is written
+        // synchronously, once the queued records have been written
+        if (type == LogType::FatalType) {
+            const auto deadline =
+                std::chrono::steady_clock::now() + FatalFlushTimeout;
+            while (!sink.empty()
+                   && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(WriterPeriod);
+            }
+            sink.write(record, message);
+            if (sink.file) {
+                std::fflush(sink.file);
+            }
+            sink.producers.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+
+        sink.push(record, message);
+        sink.producers.fetch_sub(1, std::memory_order_release);
+    }
+} // namespace
+
+bool openvr_log::Install(const AsyncLogOptions& options)
+{
+    Sink& sink = Instance();
+    const auto lock = std::unique_lock(sink.installMutex);
+
+    if (sink.references == 0 && !sink.start(options)) {
+        return false;
+    }
+
+    sink.references++;
+    return true;
+}
+
+void openvr_log::Uninstall()
+{
+    Sink& sink = Instance();
+    const auto lock = std::unique_lock(sink.installMutex);
+
+    if (sink.references == 0) {
+        return;
+    }
+
+    if (--sink.references == 0) {
+        sink.stop();
+    }
+}
+
+uint64_t openvr_log::DroppedRecords()
+{
+    return Instance().dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef YARP_OPENVR_ASYNC_LOG_H
+#define YARP_OPENVR_ASYNC_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace openvr_log {
+    struct AsyncLogOptions;
+
+    // Replace the YARP print callback with one that copies the records in a
+    // lock-free ring, written by a background thread. The library is static,
+    // so every binary linking it (the trackers module, the camera plugin)
+    // has its own sink. Within a binary the calls are reference counted:
+    // only the first call applies the options, and the last Uninstall
+    // restores the previous callback after writing the queued records.
+    bool Install(const AsyncLogOptions& options);
+    void Uninstall();
+
+    // Records dropped since the installation because the ring was full
+    uint64_t DroppedRecords();
+} // namespace openvr_log
+
+struct openvr_log::AsyncLogOptions
+{
+    // Largest number of records of the ring
+    static constexpr size_t MaxCapacity = size_t(1) << 20;
+
+    // Number of records of the ring, rounded up to a power of two and
+    // limited to MaxCapacity
+    size_t capacity = 1024;
+    // Longer messages are truncated
+    size_t maxMessageLength = 480;
+    // Append the records to this file instead of printing them through the
+    // previous callback, if not empty
+    std::string file;
+};
+
+#endif // YARP_OPENVR_ASYNC_LOG_H
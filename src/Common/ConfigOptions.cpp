@@ -0,0 +1,30 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "ConfigOptions.h"
+
+#include <yarp/os/Value.h>
+
+bool openvr_common::FindNumber(const yarp::os::Searchable& config,
+                               const std::string& key,
+                               double& value)
+{
+    if (!config.check(key)) {
+        return true;
+    }
+
+    const yarp::os::Value& option = config.find(key);
+    if (!(option.isFloat64() || option.isInt32() || option.isInt64())) {
+        return false;
+    }
+
+    value = option.asFloat64();
+    return true;
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef YARP_OPENVR_COMMON_CONFIG_OPTIONS_H
+#define YARP_OPENVR_COMMON_CONFIG_OPTIONS_H
+
+#include <yarp/os/Searchable.h>
+
+#include <string>
+
+namespace openvr_common {
+    // Read a numeric option, written either as an integer or as a floating
+    // point value. The value is left unchanged if the option is missing,
+    // and false is returned if the option is present but is not a number.
+    bool FindNumber(const yarp::os::Searchable& config,
+                    const std::string& key,
+                    double& value);
+} // namespace openvr_common
+
+#endif // YARP_OPENVR_COMMON_CONFIG_OPTIONS_H
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#endif
+
+struct openvr_common::MappedFile::Impl
+{
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    std::string error;
+
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    size_t pageSize = 4096;
+#endif
+};
+
+openvr_common::MappedFile::MappedFile()
+    : pImpl{std::make_unique<Impl>()}
+{}
+
+openvr_common::MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool openvr_common::MappedFile::open(const std::string& path)
+{
+    close();
+    pImpl->error.clear();
+
+    pImpl->file = CreateFileA(path.c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN,
+                              nullptr);
+    if (pImpl->file == INVALID_HANDLE_VALUE) {
+        pImpl->error = "Failed to open " + path + " (error "
+                       + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(pImpl->file, &size)) {
+        pImpl->error = "Failed to read the size of " + path + " (error "
+                       + std::to_string(GetLastError()) + ")";
+        close();
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        return true;
+    }
+
+    pImpl->mapping = CreateFileMappingA(
+        pImpl->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!pImpl->mapping) {
+        pImpl->error = "Failed to map " + path + " (error "
+                       + std::to_string(GetLastError()) + ")";
+        close();
+        return false;
+    }
+
+    pImpl->data = static_cast<const uint8_t*>(
+        MapViewOfFile(pImpl->mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!pImpl->data) {
+        pImpl->error = "Failed to map " + path + " (error "
+                       + std::to_string(GetLastError()) + ")";
+        close();
+        return false;
+    }
+    pImpl->size = static_cast<size_t>(size.QuadPart);
+
+    return true;
+}
+
+void openvr_common::MappedFile::close()
+{
+    if (pImpl->data) {
+        UnmapViewOfFile(pImpl->data);
+        pImpl->data = nullptr;
+    }
+    if (pImpl->mapping) {
+        CloseHandle(pImpl->mapping);
+        pImpl->mapping = nullptr;
+    }
+    if (pImpl->file != INVALID_HANDLE_VALUE) {
+        CloseHandle(pImpl->file);
+        pImpl->file = INVALID_HANDLE_VALUE;
+    }
+    pImpl->size = 0;
+}
+
+void openvr_common::MappedFile::prefetch(const size_t /*offset*/,
+                                         const size_t /*length*/) const
+{
+    // The sequential scan flag of the file already enables the read-ahead
+}
+
+#else
+
+bool openvr_common::MappedFile::open(const std::string& path)
+{
+    close();
+    pImpl->error.clear();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        pImpl->error = "Failed to open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat status = {};
+    if (fstat(fd, &status) != 0) {
+        pImpl->error = "Failed to read the size of " + path + ": "
+                       + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    if (status.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void* data = mmap(nullptr,
+                      static_cast<size_t>(status.st_size),
+                      PROT_READ,
+                      MAP_PRIVATE,
+                      fd,
+                      0);
+
+    // The mapping keeps a reference to the file
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        pImpl->error = "Failed to map " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    pImpl->data = static_cast<const uint8_t*>(data);
+    pImpl->size = static_cast<size_t>(status.st_size);
+    pImpl->pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    madvise(data, pImpl->size, MADV_SEQUENTIAL);
+
+    return true;
+}
+
+void openvr_common::MappedFile::close()
+{
+    if (pImpl->data) {
+        munmap(const_cast<uint8_t*>(pImpl->data), pImpl->size);
+        pImpl->data = nullptr;
+    }
+    pImpl->size = 0;
+}
+
+void openvr_common::MappedFile::prefetch(const size_t offset,
+                                         const size_t length) const
+{
+    if (!pImpl->data || offset >= pImpl->size) {
+        return;
+    }
+
+    // madvise needs an address aligned to the page size
+    const size_t begin = offset - offset % pImpl->pageSize;
+    const size_t end = std::min(offset + length, pImpl->size);
+
+    madvise(const_cast<uint8_t*>(pImpl->data) + begin,
+            end - begin,
+            MADV_WILLNEED);
+}
+
+#endif
+
+const uint8_t* openvr_common::MappedFile::data() const
+{
+    return pImpl->data;
+}
+
+size_t openvr_common::MappedFile::size() const
+{
+    return pImpl->size;
+}
+
+const std::string& openvr_common::MappedFile::error() const
+{
+    return pImpl->error;
+}
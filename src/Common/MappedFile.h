@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef YARP_OPENVR_COMMON_MAPPED_FILE_H
+#define YARP_OPENVR_COMMON_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace openvr_common {
+    class MappedFile;
+} // namespace openvr_common
+
+// Read-only memory mapping of a whole file. An empty file is opened
+// without a mapping: data() is null and size() is zero.
+class openvr_common::MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // On failure, error() describes the cause
+    bool open(const std::string& path);
+    void close();
+
+    const uint8_t* data() const;
+    size_t size() const;
+    const std::string& error() const;
+
+    // Hint that the given range is going to be read soon, so that it is
+    // paged in ahead of the access. It does nothing where not supported.
+    void prefetch(const size_t offset, const size_t length) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+#endif // YARP_OPENVR_COMMON_MAPPED_FILE_H
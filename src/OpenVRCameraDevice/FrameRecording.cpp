@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "FrameRecording.h"
+#include "OpenVRCameraLogComponent.h"
+
+#include <yarp/os/LogStream.h>
+
+#include <cstdio>
+#include <type_traits>
+
+namespace {
+    // Alignment of the frames inside a record
+    constexpr uint64_t FrameAlignment = 64;
+
+    constexpr uint64_t AlignUp(const uint64_t value, const uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    static_assert(std::is_trivially_copyable_v<
+                      openvr_camera::RecordingFileHeader>
+                  && sizeof(openvr_camera::RecordingFileHeader) == 40);
+    static_assert(sizeof(openvr_camera::RecordingFrameType) == 16);
+    static_assert(sizeof(openvr_camera::RecordingCamera) == 88);
+    static_assert(sizeof(openvr_camera::RecordingFrameHeader) == 24);
+} // namespace
+
+uint64_t openvr_camera::RecordingLayout(
+    const std::vector<RecordingFrameType>& types,
+    std::vector<uint64_t>& frameOffsets)
+{
+    frameOffsets.clear();
+
+    uint64_t offset = AlignUp(sizeof(RecordingFrameHeader), FrameAlignment);
+    for (const auto& type : types) {
+        frameOffsets.push_back(offset);
+        offset += AlignUp(uint64_t{4} * type.width * type.height,
+                          FrameAlignment);
+    }
+
+    return AlignUp(offset, RecordingAlignment);
+}
+
+struct openvr_camera::FrameRecorder::Impl
+{
+    std::FILE* file = nullptr;
+    std::string path;
+
+    std::vector<RecordingFrameType> types;
+    std::vector<uint64_t> frameOffsets;
+    uint64_t recordSize = 0;
+    size_t records = 0;
+
+    // Write count zeros, count is less than the alignment of the records
+    bool pad(const uint64_t count);
+};
+
+bool openvr_camera::FrameRecorder::Impl::pad(const uint64_t count)
+{
+    static const std::array<uint8_t, RecordingAlignment> zeros = {};
+    return count == 0 || std::fwrite(zeros.data(), count, 1, file) == 1;
+}
+
+openvr_camera::FrameRecorder::FrameRecorder()
+    : pImpl{std::make_unique<Impl>()}
+{}
+
+openvr_camera::FrameRecorder::~FrameRecorder()
+{
+    close();
+}
+
+bool openvr_camera::FrameRecorder::open(
+    const std::string& path,
+    const std::vector<FrameType>& types,
+    const std::vector<std::pair<uint32_t, uint32_t>>& sizes,
+    const std::vector<CameraCalibration>& cameras)
+{
+    close();
+
+    if (types.empty() || types.size() != sizes.size()) {
+        yCError(CAMERA) << "Invalid frame types to record.";
+        return false;
+    }
+
+    pImpl->types.clear();
+    for (size_t i = 0; i < types.size(); ++i) {
+        RecordingFrameType type;
+        type.type = static_cast<uint32_t>(types[i]);
+        type.width = sizes[i].first;
+        type.height = sizes[i].second;
+        pImpl->types.push_back(type);
+    }
+
+    std::vector<RecordingCamera> recordedCameras;
+    for (const auto& camera : cameras) {
+        RecordingCamera recorded;
+        recorded.x = camera.x;
+        recorded.y = camera.y;
+        recorded.width = camera.width;
+        recorded.height = camera.height;
+        recorded.model = static_cast<uint32_t>(camera.model);
+        recorded.fx = camera.fx;
+        recorded.fy = camera.fy;
+        recorded.cx = camera.cx;
+        recorded.cy = camera.cy;
+        recorded.coefficients = camera.coefficients;
+        recordedCameras.push_back(recorded);
+    }
+
+    RecordingFileHeader header;
+    header.typeCount = static_cast<uint32_t>(pImpl->types.size());
+    header.cameraCount = static_cast<uint32_t>(recordedCameras.size());
+    header.dataOffset =
+        AlignUp(sizeof(RecordingFileHeader)
+                    + sizeof(RecordingFrameType) * pImpl->types.size()
+                    + sizeof(RecordingCamera) * recordedCameras.size(),
+                RecordingAlignment);
+    header.recordSize = RecordingLayout(pImpl->types, pImpl->frameOffsets);
+    pImpl->recordSize = header.recordSize;
+
+    pImpl->file = std::fopen(path.c_str(), "wb");
+    if (!pImpl->file) {
+        yCError(CAMERA) << "Failed to create the recording" << path;
+        return false;
+    }
+    pImpl->path = path;
+
+    const uint64_t written = sizeof(RecordingFileHeader)
+                             + sizeof(RecordingFrameType) * pImpl->types.size()
+                             + sizeof(RecordingCamera) * recordedCameras.size();
+
+    const bool ok =
+        std::fwrite(&header, sizeof(header), 1, pImpl->file) == 1
+        && std::fwrite(pImpl->types.data(),
+                       sizeof(RecordingFrameType),
+                       pImpl->types.size(),
+                       pImpl->file)
+               == pImpl->types.size()
+        && std::fwrite(recordedCameras.data(),
+                       sizeof(RecordingCamera),
+                       recordedCameras.size(),
+                       pImpl->file)
+               == recordedCameras.size()
+        && pImpl->pad(header.dataOffset - written);
+
+    if (!ok) {
+        yCError(CAMERA) << "Failed to write the recording" << path;
+        close();
+        return false;
+    }
+
+    pImpl->records = 0;
+
+    yCInfo(CAMERA) << "Recording" << pImpl->types.size()
+                   << "frame type(s) to" << path << "," << pImpl->recordSize
+                   << "bytes per capture.";
+
+    return true;
+}
+
+void openvr_camera::FrameRecorder::close()
+{
+    if (!pImpl->file) {
+        return;
+    }
+
+    if (std::fclose(pImpl->file) != 0) {
+        yCError(CAMERA) << "Failed to close the recording" << pImpl->path;
+    }
+    else {
+        yCInfo(CAMERA) << "Recorded" << pImpl->records << "captures to"
+                       << pImpl->path;
+    }
+    pImpl->file = nullptr;
+}
+
+bool openvr_camera::FrameRecorder::write(const std::vector<Frame>& frames,
+                                         const FrameHeader& header)
+{
+    if (!pImpl->file) {
+        return false;
+    }
+
+    if (frames.size() != pImpl->types.size()) {
+        yCError(CAMERA) << "Unexpected number of frames to record.";
+        return false;
+    }
+
+    RecordingFrameHeader recorded;
+    recorded.sequence = header.sequence;
+    recorded.exposureTime = header.exposureTime;
+    recorded.timestamp = header.timestamp;
+
+    if (std::fwrite(&recorded, sizeof(recorded), 1, pImpl->file) != 1) {
+        yCError(CAMERA) << "Failed to write the recording" << pImpl->path;
+        return false;
+    }
+    uint64_t offset = sizeof(recorded);
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const Frame& frame = frames[i];
+        const RecordingFrameType& type = pImpl->types[i];
+        const size_t bytes = size_t{4} * type.width * type.height;
+
+        if (frame.width != type.width || frame.height != type.height
+            || frame.rgba.size() != bytes) {
+            yCError(CAMERA) << "Unexpected size of the frames to record.";
+            return false;
+        }
+
+        if (!pImpl->pad(pImpl->frameOffsets[i] - offset)
+            || std::fwrite(frame.rgba.data(), bytes, 1, pImpl->file) != 1) {
+            yCError(CAMERA) << "Failed to write the recording" << pImpl->path;
+            return false;
+        }
+        offset = pImpl->frameOffsets[i] + bytes;
+    }
+
+    if (!pImpl->pad(pImpl->recordSize - offset)) {
+        yCError(CAMERA) << "Failed to write the recording" << pImpl->path;
+        return false;
+    }
+
+    pImpl->records++;
+    return true;
+}
+
+size_t openvr_camera::FrameRecorder::records() const
+{
+    return pImpl->records;
+}
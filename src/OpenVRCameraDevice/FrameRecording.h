@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef YARP_OPENVR_CAMERA_FRAME_RECORDING_H
+#define YARP_OPENVR_CAMERA_FRAME_RECORDING_H
+
+#include "FrameSource.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace openvr_camera {
+    struct RecordingFileHeader;
+    struct RecordingFrameType;
+    struct RecordingCamera;
+    struct RecordingFrameHeader;
+    class FrameRecorder;
+
+    // A recording is made of a file header, followed by the frame types and
+    // the calibration of the cameras, and by one record per capture starting
+    // at dataOffset. Each record is a RecordingFrameHeader followed by the
+    // RGBA frames of all the types, each one starting at the offset given by
+    // RecordingLayout(). All the values are stored in the native byte order.
+    //
+    // The records have a fixed size and are aligned to the page size, so
+    // they can be read directly from a memory mapping of the file. The
+    // number of records is given by the size of the file, and a recording
+    // interrupted while writing a record is still readable.
+    constexpr std::array<char, 8> RecordingMagic = {
+        'O', 'V', 'R', 'C', 'A', 'M', 'R', 'E'};
+    constexpr uint32_t RecordingVersion = 1;
+    constexpr uint64_t RecordingAlignment = 4096;
+
+    // Offsets of the frames in a record, returns the size of the record
+    uint64_t RecordingLayout(const std::vector<RecordingFrameType>& types,
+                             std::vector<uint64_t>& frameOffsets);
+} // namespace openvr_camera
+
+struct openvr_camera::RecordingFileHeader
+{
+    std::array<char, 8> magic = RecordingMagic;
+    uint32_t version = RecordingVersion;
+    uint32_t typeCount = 0;
+    uint32_t cameraCount = 0;
+    uint32_t reserved = 0;
+    uint64_t dataOffset = 0;
+    uint64_t recordSize = 0;
+};
+
+struct openvr_camera::RecordingFrameType
+{
+    // Value of FrameType
+    uint32_t type = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t reserved = 0;
+};
+
+struct openvr_camera::RecordingCamera
+{
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    // Value of DistortionModel
+    uint32_t model = 0;
+    uint32_t reserved = 0;
+    double fx = 0.0;
+    double fy = 0.0;
+    double cx = 0.0;
+    double cy = 0.0;
+    std::array<double, 4> coefficients = {};
+};
+
+struct openvr_camera::RecordingFrameHeader
+{
+    uint32_t sequence = 0;
+    uint32_t reserved = 0;
+    uint64_t exposureTime = 0;
+    double timestamp = 0.0;
+};
+
+// Writer of the captures grabbed from a frame source to a recording file
+class openvr_camera::FrameRecorder
+{
+public:
+    FrameRecorder();
+    ~FrameRecorder();
+
+    bool open(const std::string& path,
+              const std::vector<FrameType>& types,
+              const std::vector<std::pair<uint32_t, uint32_t>>& sizes,
+              const std::vector<CameraCalibration>& cameras);
+    void close();
+
+    // Append a capture, the frames must have the types and sizes given to
+    // open(). The frames are written synchronously.
+    bool write(const std::vector<Frame>& frames, const FrameHeader& header);
+
+    // Number of captures written so far
+    size_t records() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+#endif // YARP_OPENVR_CAMERA_FRAME_RECORDING_H
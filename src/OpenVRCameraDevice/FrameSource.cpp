@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "FrameSource.h"
+
+std::string openvr_camera::FrameTypeName(const FrameType type)
+{
+    switch (type) {
+        case FrameType::Distorted:
+            return "distorted";
+        case FrameType::Undistorted:
+            return "undistorted";
+        case FrameType::MaximumUndistorted:
+            return "maximumUndistorted";
+    }
+    return "unknown";
+}
+
+std::optional<openvr_camera::FrameType>
+openvr_camera::ParseFrameType(const std::string& name)
+{
+    for (const auto type : {FrameType::Distorted,
+                            FrameType::Undistorted,
+                            FrameType::MaximumUndistorted}) {
+        if (name == FrameTypeName(type)) {
+            return type;
+        }
+    }
+    return std::nullopt;
+}
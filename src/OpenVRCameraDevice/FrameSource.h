@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef YARP_OPENVR_CAMERA_FRAME_SOURCE_H
+#define YARP_OPENVR_CAMERA_FRAME_SOURCE_H
+
+#include <yarp/os/Searchable.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace openvr_camera {
+    struct CameraCalibration;
+    struct Frame;
+    struct FrameHeader;
+    class FrameSource;
+
+    // Values of vr::EVRTrackedCameraFrameType
+    enum class FrameType
+    {
+        Distorted = 0,
+        Undistorted = 1,
+        MaximumUndistorted = 2,
+    };
+
+    enum class DistortionModel
+    {
+        None,
+        // Equidistant fisheye, the distorted angle of a ray is
+        // theta (1 + k1 theta^2 + k2 theta^4 + k3 theta^6 + k4 theta^8)
+        FTheta,
+    };
+
+    enum class GrabResult
+    {
+        NewFrame,
+        NoNewFrame,
+        Error,
+    };
+
+    std::string FrameTypeName(const FrameType type);
+    std::optional<FrameType> ParseFrameType(const std::string& name);
+} // namespace openvr_camera
+
+// RGBA image of one of the frame types streamed by a source
+struct openvr_camera::Frame
+{
+    FrameType type = FrameType::Undistorted;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> rgba;
+};
+
+// Intrinsics of one of the cameras whose images are tiled in the distorted
+// frames. The intrinsics are in pixels of the tile.
+struct openvr_camera::CameraCalibration
+{
+    // Tile of the camera in the frame
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    double fx = 0.0;
+    double fy = 0.0;
+    double cx = 0.0;
+    double cy = 0.0;
+
+    DistortionModel model = DistortionModel::None;
+    std::array<double, 4> coefficients = {};
+};
+
+// Metadata shared by all the frame types of the same capture
+struct openvr_camera::FrameHeader
+{
+    uint32_t sequence = 0;
+    // Exposure time reported by the camera, in the runtime clock
+    uint64_t exposureTime = 0;
+    // YARP time at which the frame was grabbed, not of its exposure
+    double timestamp = 0.0;
+};
+
+// Producer of the RGBA frames exposed by the OpenVRCamera device
+class openvr_camera::FrameSource
+{
+public:
+    virtual ~FrameSource() = default;
+
+    // Open the source streaming the given frame types, all of them are
+    // read by every grab() from the same capture
+    virtual bool open(yarp::os::Searchable& config,
+                      const std::vector<FrameType>& types) = 0;
+    virtual void close() = 0;
+
+    // Size of the frames of the given type, by index in the opened types
+    virtual uint32_t width(const size_t frame) const = 0;
+    virtual uint32_t height(const size_t frame) const = 0;
+
+    // Calibration of the cameras in the distorted frames, read when the
+    // source is opened. It is empty if not provided by the source.
+    virtual std::vector<CameraCalibration> calibration() const = 0;
+
+    // The source is opened without streaming. The streaming is started by
+    // startStreaming() or by the first grab(), and can be stopped while no
+    // frames are needed.
+    virtual bool startStreaming() = 0;
+    virtual void stopStreaming() = 0;
+    virtual bool streaming() const = 0;
+
+    // Copy the latest capture in the frames, one per opened type in the
+    // same order, if its sequence number differs from the one of the last
+    // grabbed capture
+    virtual GrabResult grab(std::vector<Frame>& frames,
+                            FrameHeader& header) = 0;
+};
+
+#endif // YARP_OPENVR_CAMERA_FRAME_SOURCE_H
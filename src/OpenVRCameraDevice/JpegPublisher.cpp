@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "JpegPublisher.h"
+#include "OpenVRCameraLogComponent.h"
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Value.h>
+
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#ifdef OPENVR_CAMERA_HAS_JPEG
+// jpeglib.h requires the definition of size_t and FILE
+#include <cstdio>
+#include <csetjmp>
+#include <jpeglib.h>
+#include <jerror.h>
+#endif
+
+namespace {
+    struct RgbImage
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> pixels;
+        yarp::os::Stamp stamp;
+    };
+
+#ifdef OPENVR_CAMERA_HAS_JPEG
+    struct ErrorManager
+    {
+        jpeg_error_mgr manager;
+        std::jmp_buf jump;
+    };
+
+    // Replace the default handler, that would exit the process
+    void OnError(j_common_ptr info)
+    {
+        auto* errors = reinterpret_cast<ErrorManager*>(info->err);
+        std::longjmp(errors->jump, 1);
+    }
+
+    // Destination writing in a buffer owned by the caller and reused across
+    // calls. Unlike jpeg_mem_dest(), nothing is allocated by libjpeg, so
+    // nothing leaks when an error jumps out of the encoder.
+    struct Destination
+    {
+        jpeg_destination_mgr manager;
+        std::vector<unsigned char>* buffer;
+    };
+
+    constexpr size_t InitialBufferSize = 64 * 1024;
+
+    void InitDestination(j_compress_ptr info)
+    {
+        auto* destination = reinterpret_cast<Destination*>(info->dest);
+        auto& buffer = *destination->buffer;
+        if (buffer.size() < InitialBufferSize) {
+            buffer.resize(InitialBufferSize);
+        }
+        destination->manager.next_output_byte =
+            reinterpret_cast<JOCTET*>(buffer.data());
+        destination->manager.free_in_buffer = buffer.size();
+    }
+
+    // Called when the buffer is full, that is doubled
+    boolean EmptyOutputBuffer(j_compress_ptr info)
+    {
+        auto* destination = reinterpret_cast<Destination*>(info->dest);
+        auto& buffer = *destination->buffer;
+        const size_t used = buffer.size();
+
+        bool grown = true;
+        try {
+            buffer.resize(2 * used);
+        }
+        catch (const std::bad_alloc&) {
+            grown = false;
+        }
+        if (!grown) {
+            ERREXIT1(info, JERR_OUT_OF_MEMORY, 0);
+        }
+
+        destination->manager.next_output_byte =
+            reinterpret_cast<JOCTET*>(buffer.data() + used);
+        destination->manager.free_in_buffer = buffer.size() - used;
+        return TRUE;
+    }
+
+    void TermDestination(j_compress_ptr) {}
+
+    bool Encode(const RgbImage& image,
+                const int quality,
+                std::vector<unsigned char>& buffer,
+                size_t& size)
+    {
+        jpeg_compress_struct info;
+        ErrorManager errors;
+        info.err = jpeg_std_error(&errors.manager);
+        errors.manager.error_exit = OnError;
+
+        Destination destination;
+        destination.manager.init_destination = InitDestination;
+        destination.manager.empty_output_buffer = EmptyOutputBuffer;
+        destination.manager.term_destination = TermDestination;
+        destination.buffer = &buffer;
+
+        if (setjmp(errors.jump)) {
+            jpeg_destroy_compress(&info);
+            return false;
+        }
+
+        jpeg_create_compress(&info);
+        info.dest = &destination.manager;
+
+        info.image_width = image.width;
+        info.image_height = image.height;
+        info.input_components = 3;
+        info.in_color_space = JCS_RGB;
+        jpeg_set_defaults(&info);
+        jpeg_set_quality(&info, quality, TRUE);
+        info.dct_method = JDCT_IFAST;
+
+        jpeg_start_compress(&info, TRUE);
+        const size_t rowSize = static_cast<size_t>(image.width) * 3;
+        while (info.next_scanline < info.image_height) {
+            auto row = const_cast<JSAMPROW>(image.pixels.data()
+                                            + info.next_scanline * rowSize);
+            jpeg_write_scanlines(&info, &row, 1);
+        }
+        jpeg_finish_compress(&info);
+        size = buffer.size() - destination.manager.free_in_buffer;
+        jpeg_destroy_compress(&info);
+
+        return true;
+    }
+#endif
+} // namespace
+
+class openvr_camera::JpegPublisher::Impl
+{
+public:
+    int quality = 85;
+    yarp::os::BufferedPort<yarp::os::Bottle> port;
+
+    // The latest image submitted and not yet encoded
+    RgbImage pending;
+    bool hasPending = false;
+    RgbImage encoding;
+
+    std::thread worker;
+    bool stopWorker = false;
+    std::condition_variable workerWakeUp;
+    std::mutex mutex;
+
+    std::vector<unsigned char> buffer;
+
+    void run();
+};
+
+void openvr_camera::JpegPublisher::Impl::run()
+{
+    auto lock = std::unique_lock(mutex);
+
+    while (true) {
+        workerWakeUp.wait(lock, [this] { return stopWorker || hasPending; });
+        if (stopWorker) {
+            break;
+        }
+
+        std::swap(pending, encoding);
+        hasPending = false;
+        lock.unlock();
+
+#ifdef OPENVR_CAMERA_HAS_JPEG
+        size_t size = 0;
+        if (Encode(encoding, quality, buffer, size)) {
+            yarp::os::Bottle& bottle = port.prepare();
+            bottle.clear();
+            bottle.addInt32(static_cast<int32_t>(encoding.width));
+            bottle.addInt32(static_cast<int32_t>(encoding.height));
+            bottle.add(yarp::os::Value::makeBlob(buffer.data(), size));
+            port.setEnvelope(encoding.stamp);
+            port.write();
+        }
+        else {
+            yCError(CAMERA) << "Failed to encode the JPEG image.";
+        }
+#endif
+
+        lock.lock();
+    }
+}
+
+openvr_camera::JpegPublisher::JpegPublisher()
+    : pImpl{std::make_unique<Impl>()}
+{}
+
+openvr_camera::JpegPublisher::~JpegPublisher()
+{
+    close();
+}
+
+bool openvr_camera::JpegPublisher::Available()
+{
+#ifdef OPENVR_CAMERA_HAS_JPEG
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool openvr_camera::JpegPublisher::open(const std::string& portName,
+                                        const int quality)
+{
+    if (!Available()) {
+        yCError(CAMERA) << "The plugin was built without JPEG support.";
+        return false;
+    }
+
+    if (quality < 1 || quality > 100) {
+        yCError(CAMERA) << "Invalid JPEG quality" << quality
+                        << "(allowed values: 1-100).";
+        return false;
+    }
+    pImpl->quality = quality;
+
+    if (!pImpl->port.open(portName)) {
+        yCError(CAMERA) << "Failed to open the output" << portName;
+        return false;
+    }
+
+    pImpl->stopWorker = false;
+    pImpl->worker = std::thread([this] { pImpl->run(); });
+
+    yCInfo(CAMERA) << "Publishing JPEG images with quality" << quality
+                   << "on" << portName;
+    return true;
+}
+
+void openvr_camera::JpegPublisher::close()
+{
+    if (pImpl->worker.joinable()) {
+        {
+            const auto lock = std::unique_lock(pImpl->mutex);
+            pImpl->stopWorker = true;
+        }
+        pImpl->workerWakeUp.notify_all();
+        pImpl->worker.join();
+        pImpl->port.close();
+    }
+
+    pImpl->buffer = {};
+}
+
+size_t openvr_camera::JpegPublisher::readers()
+{
+    return pImpl->worker.joinable() ? pImpl->port.getOutputCount() : 0;
+}
+
+void openvr_camera::JpegPublisher::submit(
+    const yarp::sig::ImageOf<yarp::sig::PixelRgb>& image,
+    const yarp::os::Stamp& stamp)
+{
+    if (!pImpl->worker.joinable() || pImpl->port.getOutputCount() == 0) {
+        return;
+    }
+
+    {
+        const auto lock = std::unique_lock(pImpl->mutex);
+
+        // Rows of YARP images may be padded, the copy is packed
+        RgbImage& pending = pImpl->pending;
+        pending.width = static_cast<uint32_t>(image.width());
+        pending.height = static_cast<uint32_t>(image.height());
+        pending.stamp = stamp;
+
+        const size_t rowSize = static_cast<size_t>(pending.width) * 3;
+        pending.pixels.resize(rowSize * pending.height);
+        for (uint32_t y = 0; y < pending.height; ++y) {
+            std::memcpy(pending.pixels.data() + y * rowSize,
+                        image.getRow(y),
+                        rowSize);
+        }
+
+        pImpl->hasPending = true;
+    }
+    pImpl->workerWakeUp.notify_one();
+}
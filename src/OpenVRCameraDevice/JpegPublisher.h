@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef YARP_OPENVR_CAMERA_JPEG_PUBLISHER_H
+#define YARP_OPENVR_CAMERA_JPEG_PUBLISHER_H
+
+#include <yarp/os/Stamp.h>
+#include <yarp/sig/Image.h>
+
+#include <memory>
+#include <string>
+
+namespace openvr_camera {
+    class JpegPublisher;
+} // namespace openvr_camera
+
+// Publisher of JPEG-compressed images. The images are encoded once on a
+// worker thread and published on a port as a Bottle (width height blob),
+// with the envelope of the submitted image. If the worker is still busy,
+// only the latest submitted image is kept.
+class openvr_camera::JpegPublisher
+{
+public:
+    JpegPublisher();
+    ~JpegPublisher();
+
+    // Whether the plugin was built with a JPEG encoder
+    static bool Available();
+
+    bool open(const std::string& portName, const int quality);
+    void close();
+
+    size_t readers();
+
+    // Copy the image for the worker thread, only if the port has readers
+    void submit(const yarp::sig::ImageOf<yarp::sig::PixelRgb>& image,
+                const yarp::os::Stamp& stamp);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+#endif // YARP_OPENVR_CAMERA_JPEG_PUBLISHER_H
@@ -9,30 +9,209 @@
  */
 
 #include "OpenVRCamera.h"
+#include "AsyncLog.h"
+#include "ConfigOptions.h"
+#include "FrameRecording.h"
+#include "JpegPublisher.h"
+#include "OpenVRCameraLogComponent.h"
+#include "OutputStreams.h"
+#include "ReplayFrameSource.h"
+#include "SyntheticFrameSource.h"
+#include "TrackedCameraSource.h"
+#include "Undistortion.h"
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
 #include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
 
-#include <openvr.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
 
-// Adapted from
-// https://github.com/ValveSoftware/openvr/blob/91825305130f446f82054c1ec3d416321ace0072/samples/tracked_camera_openvr_sample/tracked_camera_openvr_sample.cpp
-
-YARP_DECLARE_LOG_COMPONENT(CAMERA)
 YARP_LOG_COMPONENT(CAMERA, "yarp.device.OpenVRCamera")
 
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr double DefaultIdleTimeout = 5.0;
+    constexpr int DefaultJpegQuality = 85;
+    const std::string DefaultOutputsPrefix = "/OpenVRCamera";
+    constexpr auto MonitorPeriod = std::chrono::milliseconds(100);
+    constexpr auto ReadersCheckPeriod = std::chrono::milliseconds(500);
+
+    // Number of output connections of a port, read from its administrative
+    // interface
+    std::optional<size_t> OutputConnections(const std::string& portName)
+    {
+        const yarp::os::Contact contact =
+            yarp::os::Network::queryName(portName);
+        if (!contact.isValid()) {
+            return std::nullopt;
+        }
+
+        yarp::os::Bottle command;
+        yarp::os::Bottle reply;
+        command.addString("list");
+        command.addString("out");
+
+        if (!yarp::os::Network::write(contact,
+                                      command,
+                                      reply,
+                                      /*admin=*/true,
+                                      /*quiet=*/true,
+                                      /*timeout=*/0.5)) {
+            return std::nullopt;
+        }
+
+        return reply.size();
+    }
+
+    void ConvertToRgb(const openvr_camera::Frame& frame,
+                      yarp::sig::ImageOf<yarp::sig::PixelRgb>& image)
+    {
+        image.resize(frame.width, frame.height);
+        const uint8_t* pFrameImage = frame.rgba.data();
+        for (uint32_t y = 0; y < frame.height; y++) {
+            for (uint32_t x = 0; x < frame.width; x++) {
+                image.pixel(x, y).r = pFrameImage[3] > 0 ? pFrameImage[0] : 0;
+                image.pixel(x, y).g = pFrameImage[3] > 0 ? pFrameImage[1] : 0;
+                image.pixel(x, y).b = pFrameImage[3] > 0 ? pFrameImage[2] : 0;
+                pFrameImage += 4; // advance by 4 bytes (RGBA)
+            }
+        }
+    }
+} // namespace
+
 struct yarp::dev::OpenVRCamera::Impl
 {
-    vr::IVRSystem* pVRSystem;
-    vr::IVRTrackedCamera* pVRTrackedCamera;
-    vr::TrackedCameraHandle_t hTrackedCamera;
+    std::unique_ptr<openvr_camera::FrameSource> source;
+
+    // The first frame type is returned by getImage(), the others are
+    // published on the outputs with the same envelope
+    using Output =
+        yarp::os::BufferedPort<yarp::sig::ImageOf<yarp::sig::PixelRgb>>;
+    std::vector<openvr_camera::Frame> frames;
+    std::vector<std::unique_ptr<Output>> outputs;
+
+    // Frame of the source each requested frame type is computed from. With
+    // the undistortion on the CPU, the undistorted frames are remapped from
+    // the distorted ones.
+    struct FrameMapping
+    {
+        openvr_camera::FrameType type;
+        size_t sourceFrame;
+        bool remap;
+    };
+    std::vector<FrameMapping> mapping;
+    openvr_camera::RemapTable remapTable;
+
+    // Optional compressed copy of the image returned by getImage()
+    std::unique_ptr<openvr_camera::JpegPublisher> jpeg;
+
+    // Optional streams of other resolutions and formats
+    std::unique_ptr<openvr_camera::OutputStreams> streams;
+
+    // Optional recording of the captures grabbed from the source, which can
+    // be replayed later with the replay source
+    std::unique_ptr<openvr_camera::FrameRecorder> recorder;
+
+    // Whether the asynchronous log sink was installed by the device
+    bool asyncLog = false;
+
+    void convert(const size_t i,
+                 yarp::sig::ImageOf<yarp::sig::PixelRgb>& image) const;
+
+    openvr_camera::FrameHeader lastHeader;
+    yarp::os::Stamp lastStamp;
+
+    // The streaming is stopped when no frames are requested for more than
+    // idleTimeout seconds. If readersPort is set, frames are served only
+    // while that port, usually the one of the wrapper, has connections.
+    double idleTimeout = DefaultIdleTimeout;
+    std::string readersPort;
+    std::atomic<bool> hasReaders{true};
+    Clock::time_point lastRequest;
+
+    std::thread monitor;
+    bool stopMonitor = false;
+    std::condition_variable monitorWakeUp;
+
+    // Protects the source, shared by getImage() and the monitor
+    std::mutex mutex;
+
+    void monitorStreaming();
+};
+
+void yarp::dev::OpenVRCamera::Impl::convert(
+    const size_t i,
+    yarp::sig::ImageOf<yarp::sig::PixelRgb>& image) const
+{
+    const openvr_camera::Frame& frame = frames[mapping[i].sourceFrame];
+    if (mapping[i].remap) {
+        remapTable.apply(frame, image);
+    }
+    else {
+        ConvertToRgb(frame, image);
+    }
+}
 
-    std::string HMDSerialNumberString;
+void yarp::dev::OpenVRCamera::Impl::monitorStreaming()
+{
+    auto nextReadersCheck = Clock::now();
+
+    auto lock = std::unique_lock(mutex);
+    while (!monitorWakeUp.wait_for(
+        lock, MonitorPeriod, [this] { return stopMonitor; })) {
+
+        const auto now = Clock::now();
+
+        if (!readersPort.empty() && now >= nextReadersCheck) {
+            nextReadersCheck = now + ReadersCheckPeriod;
+
+            // Query the port without holding the lock
+            lock.unlock();
+            const auto readers = OutputConnections(readersPort);
+            lock.lock();
+
+            // The readers of the other frame types count as well
+            size_t outputReaders = (jpeg ? jpeg->readers() : 0)
+                                   + (streams ? streams->readers() : 0);
+            for (const auto& output : outputs) {
+                outputReaders += output->getOutputCount();
+            }
+
+            const bool hadReaders = hasReaders;
+            hasReaders = readers.value_or(0) + outputReaders > 0;
+
+            // Start the streaming as soon as the first reader connects, so
+            // that the frames are ready when it is served
+            if (hasReaders && !hadReaders) {
+                lastRequest = now;
+                source->startStreaming();
+            }
+        }
 
-    uint32_t nCameraFrameWidth{0};
-    uint32_t nCameraFrameHeight{0};
-    uint32_t nCameraFrameBufferSize;
-    uint8_t* pCameraFrameBuffer;
-    uint32_t nLastFrameSequence;
-};
+        const bool idle =
+            idleTimeout > 0.0
+            && now - lastRequest > std::chrono::duration<double>(idleTimeout);
+
+        if (source->streaming() && !hasReaders) {
+            yCInfo(CAMERA) << "No readers connected to" << readersPort
+                           << ", stopping the streaming.";
+            source->stopStreaming();
+        }
+        else if (source->streaming() && idle) {
+            yCInfo(CAMERA) << "No frames requested for" << idleTimeout
+                           << "s, stopping the streaming.";
+            source->stopStreaming();
+        }
+    }
+}
 
 yarp::dev::OpenVRCamera::OpenVRCamera()
     : pImpl{std::make_unique<Impl>()}
@@ -45,104 +224,265 @@ yarp::dev::OpenVRCamera::~OpenVRCamera()
 
 bool yarp::dev::OpenVRCamera::open(yarp::os::Searchable& config)
 {
-    // Loading the SteamVR Runtime
-    yCInfo(CAMERA) << "Starting OpenVR...";
-    vr::EVRInitError eError = vr::VRInitError_None;
-    pImpl->pVRSystem = vr::VR_Init(&eError, vr::VRApplication_Scene);
-    if (eError != vr::VRInitError_None) {
-        pImpl->pVRSystem = nullptr;
-        yCError(CAMERA) << "Unable to init VR runtime:"
-                        << vr::VR_GetVRInitErrorAsSymbol(eError);
-        return false;
+    // Write the log from a background thread, so that the terminal or the
+    // file never block the acquisition
+    if (!(config.check("asyncLog") && config.find("asyncLog").isBool()
+          && !config.find("asyncLog").asBool())) {
+        openvr_log::AsyncLogOptions options;
+        if (config.check("logFile") && config.find("logFile").isString()) {
+            options.file = config.find("logFile").asString();
+        }
+
+        pImpl->asyncLog = openvr_log::Install(options);
+        if (!pImpl->asyncLog) {
+            yCError(CAMERA) << "Failed to open the log file" << options.file;
+            return false;
+        }
+    }
+
+    // Try to find the "source" entry
+    std::string source = "openvr";
+    if (config.check("source") && config.find("source").isString()) {
+        source = config.find("source").asString();
+    }
+
+    if (source == "openvr") {
+        pImpl->source = std::make_unique<openvr_camera::TrackedCameraSource>();
+    }
+    else if (source == "synthetic") {
+        pImpl->source = std::make_unique<openvr_camera::SyntheticFrameSource>();
+    }
+    else if (source == "replay") {
+        pImpl->source = std::make_unique<openvr_camera::ReplayFrameSource>();
     }
     else {
-        char systemName[1024];
-        char serialNumber[1024];
-        pImpl->pVRSystem->GetStringTrackedDeviceProperty(
-            vr::k_unTrackedDeviceIndex_Hmd,
-            vr::Prop_TrackingSystemName_String,
-            systemName,
-            sizeof(systemName));
-        pImpl->pVRSystem->GetStringTrackedDeviceProperty(
-            vr::k_unTrackedDeviceIndex_Hmd,
-            vr::Prop_SerialNumber_String,
-            serialNumber,
-            sizeof(serialNumber));
-
-        pImpl->HMDSerialNumberString = serialNumber;
-
-        yCInfo(CAMERA) << "VR HMD:" << systemName << serialNumber;
-    }
-
-    pImpl->pVRTrackedCamera = vr::VRTrackedCamera();
-    if (!pImpl->pVRTrackedCamera) {
-        yCError(CAMERA) << "Unable to get Tracked Camera interface.";
+        yCError(CAMERA) << "Invalid source" << source
+                        << "(allowed values: openvr, synthetic, replay).";
         return false;
     }
 
-    bool bHasCamera = false;
-    vr::EVRTrackedCameraError nCameraError = pImpl->pVRTrackedCamera->HasCamera(
-        vr::k_unTrackedDeviceIndex_Hmd, &bHasCamera);
-
-    if (nCameraError != vr::VRTrackedCameraError_None || !bHasCamera) {
-        yCError(CAMERA) << "No Tracked Camera Available:"
-                        << pImpl->pVRTrackedCamera->GetCameraErrorNameFromEnum(
-                               nCameraError);
+    // Try to find the "idleTimeout" entry
+    if (!openvr_common::FindNumber(config, "idleTimeout", pImpl->idleTimeout)) {
+        yCError(CAMERA) << "The idleTimeout entry must be a number.";
         return false;
     }
 
-    // Accessing the FW description is just a further check to ensure camera
-    // communication is valid as expected.
-    vr::ETrackedPropertyError propertyError;
-    char buffer[128];
-    pImpl->pVRSystem->GetStringTrackedDeviceProperty(
-        vr::k_unTrackedDeviceIndex_Hmd,
-        vr::Prop_CameraFirmwareDescription_String,
-        buffer,
-        sizeof(buffer),
-        &propertyError);
-    if (propertyError != vr::TrackedProp_Success) {
-        yCError(CAMERA) << "Unable to get Tracked Camera Firmware Description:"
-                        << pImpl->pVRSystem->GetPropErrorNameFromEnum(
-                               propertyError);
+    // Try to find the "readersPort" entry
+    if (config.check("readersPort") && config.find("readersPort").isString()) {
+        pImpl->readersPort = config.find("readersPort").asString();
+        pImpl->hasReaders = false;
+    }
 
-        return false;
+    // Try to find the "frameTypes" entry
+    std::vector<openvr_camera::FrameType> types;
+    if (config.check("frameTypes")) {
+        const yarp::os::Value& value = config.find("frameTypes");
+        const yarp::os::Bottle names = value.isList()
+                                           ? *value.asList()
+                                           : yarp::os::Bottle(value.toString());
+
+        for (size_t i = 0; i < names.size(); ++i) {
+            const auto type =
+                openvr_camera::ParseFrameType(names.get(i).asString());
+            if (!type.has_value()) {
+                yCError(CAMERA) << "Invalid frame type"
+                                << names.get(i).asString()
+                                << "(allowed values: distorted, undistorted,"
+                                << "maximumUndistorted).";
+                return false;
+            }
+            // Each type has its own output, that cannot be opened twice
+            if (std::find(types.begin(), types.end(), type.value())
+                != types.end()) {
+                yCError(CAMERA) << "Duplicate frame type"
+                                << names.get(i).asString();
+                return false;
+            }
+            types.push_back(type.value());
+        }
+    }
+    if (types.empty()) {
+        types.push_back(openvr_camera::FrameType::Undistorted);
     }
 
-    yCInfo(CAMERA) << "Camera FW Description:" << buffer;
+    // Try to find the "outputsPrefix" entry, by default the name of the
+    // wrapper when started with yarpdev
+    std::string outputsPrefix = DefaultOutputsPrefix;
+    if (config.check("outputsPrefix")
+        && config.find("outputsPrefix").isString()) {
+        outputsPrefix = config.find("outputsPrefix").asString();
+    }
+    else if (config.check("name") && config.find("name").isString()) {
+        outputsPrefix = config.find("name").asString();
+    }
 
-    yCInfo(CAMERA) << "Starting video acquisition...";
+    // Try to find the "undistortion" entry
+    bool cpuUndistortion = false;
+    if (config.check("undistortion")
+        && config.find("undistortion").isString()) {
+        const std::string undistortion = config.find("undistortion").asString();
+        if (undistortion != "runtime" && undistortion != "cpu") {
+            yCError(CAMERA) << "Invalid undistortion" << undistortion
+                            << "(allowed values: runtime, cpu).";
+            return false;
+        }
+        cpuUndistortion = undistortion == "cpu";
+    }
+
+    // Frame types to read from the source, each read only once
+    std::vector<openvr_camera::FrameType> sourceTypes;
+    pImpl->mapping.clear();
+    for (const auto type : types) {
+        const bool remap =
+            cpuUndistortion && type == openvr_camera::FrameType::Undistorted;
+        const auto sourceType =
+            remap ? openvr_camera::FrameType::Distorted : type;
+
+        auto it = std::find(sourceTypes.begin(), sourceTypes.end(), sourceType);
+        if (it == sourceTypes.end()) {
+            it = sourceTypes.insert(sourceTypes.end(), sourceType);
+        }
 
-    // Allocate for camera frame buffer requirements
-    uint32_t nCameraFrameBufferSize = 0;
-    auto error = pImpl->pVRTrackedCamera->GetCameraFrameSize(
-        vr::k_unTrackedDeviceIndex_Hmd,
-        vr::VRTrackedCameraFrameType_Undistorted,
-        &pImpl->nCameraFrameWidth,
-        &pImpl->nCameraFrameHeight,
-        &nCameraFrameBufferSize);
-    if (error != vr::VRTrackedCameraError_None) {
-        yCError(CAMERA) << "GetCameraFrameBounds() Failed!";
+        pImpl->mapping.push_back(
+            {type, static_cast<size_t>(it - sourceTypes.begin()), remap});
+    }
+
+    if (!pImpl->source->open(config, sourceTypes)) {
+        pImpl->source->close();
+        pImpl->source.reset();
         return false;
     }
 
-    if (nCameraFrameBufferSize
-        && nCameraFrameBufferSize != pImpl->nCameraFrameBufferSize) {
-        delete[] pImpl->pCameraFrameBuffer;
-        pImpl->nCameraFrameBufferSize = nCameraFrameBufferSize;
-        pImpl->pCameraFrameBuffer = new uint8_t[pImpl->nCameraFrameBufferSize];
-        memset(pImpl->pCameraFrameBuffer, 0, pImpl->nCameraFrameBufferSize);
+    if (cpuUndistortion) {
+        const auto cameras = pImpl->source->calibration();
+        if (cameras.empty()) {
+            yCError(CAMERA) << "The calibration of the camera is not available,"
+                            << "cannot undistort the frames.";
+            close();
+            return false;
+        }
+
+        // The size of the distorted frames is the one of the whole tiling
+        uint32_t inputWidth = 0;
+        uint32_t inputHeight = 0;
+        for (const auto& camera : cameras) {
+            inputWidth = std::max(inputWidth, camera.x + camera.width);
+            inputHeight = std::max(inputHeight, camera.y + camera.height);
+        }
+
+        // Try to find the "undistortedWidth" and "undistortedHeight" entries
+        uint32_t outputWidth = inputWidth;
+        uint32_t outputHeight = inputHeight;
+        if (config.check("undistortedWidth")
+            && config.find("undistortedWidth").isInt32()) {
+            outputWidth = config.find("undistortedWidth").asInt32();
+        }
+        if (config.check("undistortedHeight")
+            && config.find("undistortedHeight").isInt32()) {
+            outputHeight = config.find("undistortedHeight").asInt32();
+        }
+
+        if (!pImpl->remapTable.build(
+                inputWidth, inputHeight, cameras, outputWidth, outputHeight)) {
+            close();
+            return false;
+        }
+
+        yCInfo(CAMERA) << "Undistorting on the CPU" << cameras.size()
+                       << "camera(s) to" << outputWidth << "x" << outputHeight;
+    }
+
+    // Try to find the "jpeg" and "jpegQuality" entries
+    if (config.check("jpeg") && config.find("jpeg").asBool()) {
+        int quality = DefaultJpegQuality;
+        if (config.check("jpegQuality")
+            && config.find("jpegQuality").isInt32()) {
+            quality = config.find("jpegQuality").asInt32();
+        }
+
+        pImpl->jpeg = std::make_unique<openvr_camera::JpegPublisher>();
+        if (!pImpl->jpeg->open(outputsPrefix + "/jpeg:o", quality)) {
+            close();
+            return false;
+        }
     }
 
-    pImpl->nLastFrameSequence = 0;
+    // Try to find the "streams" entry
+    if (config.check("streams")) {
+        // Sizes of the requested frame types, as read from the source
+        std::vector<std::pair<uint32_t, uint32_t>> sizes;
+        for (const auto& mapping : pImpl->mapping) {
+            sizes.emplace_back(pImpl->source->width(mapping.sourceFrame),
+                               pImpl->source->height(mapping.sourceFrame));
+        }
 
-    pImpl->pVRTrackedCamera->AcquireVideoStreamingService(
-        vr::k_unTrackedDeviceIndex_Hmd, &pImpl->hTrackedCamera);
-    if (pImpl->hTrackedCamera == INVALID_TRACKED_CAMERA_HANDLE) {
-        yCError(CAMERA) << "AcquireVideoStreamingService() Failed!";
-        return false;
+        auto streams = openvr_camera::OutputStreams::Parse(
+            config.find("streams"), types, sizes);
+        if (!streams.has_value()) {
+            close();
+            return false;
+        }
+
+        // The streams are computed directly from the frames of the source
+        std::vector<std::pair<uint32_t, uint32_t>> sourceSizes;
+        for (size_t i = 0; i < sourceTypes.size(); ++i) {
+            sourceSizes.emplace_back(pImpl->source->width(i),
+                                     pImpl->source->height(i));
+        }
+        for (auto& stream : streams.value()) {
+            if (pImpl->mapping[stream.frame].remap) {
+                yCError(CAMERA) << "Stream" << stream.name
+                                << "cannot use the frames undistorted on"
+                                << "the CPU.";
+                close();
+                return false;
+            }
+            stream.frame = pImpl->mapping[stream.frame].sourceFrame;
+        }
+
+        pImpl->streams = std::make_unique<openvr_camera::OutputStreams>();
+        if (!pImpl->streams->open(
+                outputsPrefix, streams.value(), sourceSizes)) {
+            close();
+            return false;
+        }
+    }
+
+    // Try to find the "record" entry
+    if (config.check("record") && config.find("record").isString()) {
+        std::vector<std::pair<uint32_t, uint32_t>> sourceSizes;
+        for (size_t i = 0; i < sourceTypes.size(); ++i) {
+            sourceSizes.emplace_back(pImpl->source->width(i),
+                                     pImpl->source->height(i));
+        }
+
+        pImpl->recorder = std::make_unique<openvr_camera::FrameRecorder>();
+        if (!pImpl->recorder->open(config.find("record").asString(),
+                                   sourceTypes,
+                                   sourceSizes,
+                                   pImpl->source->calibration())) {
+            close();
+            return false;
+        }
+    }
+
+    for (size_t i = 1; i < types.size(); ++i) {
+        const std::string name = outputsPrefix + "/"
+                                 + openvr_camera::FrameTypeName(types[i])
+                                 + ":o";
+        auto output = std::make_unique<Impl::Output>();
+        if (!output->open(name)) {
+            yCError(CAMERA) << "Failed to open the output" << name;
+            close();
+            return false;
+        }
+        pImpl->outputs.push_back(std::move(output));
     }
 
+    pImpl->lastRequest = Clock::now();
+    pImpl->stopMonitor = false;
+    pImpl->monitor = std::thread([this] { pImpl->monitorStreaming(); });
+
     yCInfo(CAMERA) << "OpenVRCamera device ready.";
 
     return true;
@@ -150,15 +490,43 @@ bool yarp::dev::OpenVRCamera::open(yarp::os::Searchable& config)
 
 bool yarp::dev::OpenVRCamera::close()
 {
-    if (pImpl->hTrackedCamera != INVALID_TRACKED_CAMERA_HANDLE) {
-        pImpl->pVRTrackedCamera->ReleaseVideoStreamingService(
-            pImpl->hTrackedCamera);
-        pImpl->hTrackedCamera = INVALID_TRACKED_CAMERA_HANDLE;
+    if (pImpl->monitor.joinable()) {
+        {
+            const auto lock = std::unique_lock(pImpl->mutex);
+            pImpl->stopMonitor = true;
+        }
+        pImpl->monitorWakeUp.notify_all();
+        pImpl->monitor.join();
+    }
+
+    for (auto& output : pImpl->outputs) {
+        output->close();
     }
+    pImpl->outputs.clear();
 
-    if (pImpl->pVRSystem) {
-        vr::VR_Shutdown();
-        pImpl->pVRSystem = nullptr;
+    if (pImpl->jpeg) {
+        pImpl->jpeg->close();
+        pImpl->jpeg.reset();
+    }
+
+    if (pImpl->streams) {
+        pImpl->streams->close();
+        pImpl->streams.reset();
+    }
+
+    if (pImpl->recorder) {
+        pImpl->recorder->close();
+        pImpl->recorder.reset();
+    }
+
+    if (pImpl->source) {
+        pImpl->source->close();
+        pImpl->source.reset();
+    }
+
+    if (pImpl->asyncLog) {
+        openvr_log::Uninstall();
+        pImpl->asyncLog = false;
     }
     return true;
 }
@@ -166,63 +534,62 @@ bool yarp::dev::OpenVRCamera::close()
 bool yarp::dev::OpenVRCamera::getImage(
     yarp::sig::ImageOf<yarp::sig::PixelRgb>& image)
 {
-    if (!pImpl->pVRTrackedCamera || !pImpl->hTrackedCamera) {
+    const auto lock = std::unique_lock(pImpl->mutex);
+
+    if (!pImpl->source) {
         yCError(CAMERA) << "getImage() called before camera has been opened.";
         return false;
     }
 
-    // get the frame header only
-    vr::CameraVideoStreamFrameHeader_t frameHeader;
-    vr::EVRTrackedCameraError nCameraError =
-        pImpl->pVRTrackedCamera->GetVideoStreamFrameBuffer(
-            pImpl->hTrackedCamera,
-            vr::VRTrackedCameraFrameType_Undistorted,
-            nullptr,
-            0,
-            &frameHeader,
-            sizeof(frameHeader));
-
-    if (nCameraError != vr::VRTrackedCameraError_None) {
-        yCError(CAMERA)
-            << "GetVideoStreamFrameBuffer() Failed to get frame header. Error:"
-            << pImpl->pVRTrackedCamera->GetCameraErrorNameFromEnum(
-                   nCameraError);
+    // Do not start the streaming when nobody would receive the frames
+    if (!pImpl->hasReaders) {
         return false;
     }
 
-    if (frameHeader.nFrameSequence == pImpl->nLastFrameSequence) {
-        yCWarning(CAMERA) << "No new frame available.";
-        return false;
+    pImpl->lastRequest = Clock::now();
+
+    switch (pImpl->source->grab(pImpl->frames, pImpl->lastHeader)) {
+        case openvr_camera::GrabResult::Error:
+            return false;
+        case openvr_camera::GrabResult::NoNewFrame:
+            yCWarning(CAMERA) << "No new frame available.";
+            return false;
+        case openvr_camera::GrabResult::NewFrame:
+            break;
     }
 
-    // Frame has changed, do the more expensive frame buffer copy
-    nCameraError = pImpl->pVRTrackedCamera->GetVideoStreamFrameBuffer(
-        pImpl->hTrackedCamera,
-        vr::VRTrackedCameraFrameType_Undistorted,
-        pImpl->pCameraFrameBuffer,
-        pImpl->nCameraFrameBufferSize,
-        &frameHeader,
-        sizeof(frameHeader));
-
-    if (nCameraError != vr::VRTrackedCameraError_None) {
-        yCError(CAMERA)
-            << "GetVideoStreamFrameBuffer() Failed to get frame buffer. Error:"
-            << pImpl->pVRTrackedCamera->GetCameraErrorNameFromEnum(
-                   nCameraError);
-        return false;
+    pImpl->lastStamp = yarp::os::Stamp(
+        static_cast<int>(pImpl->lastHeader.sequence),
+        pImpl->lastHeader.timestamp);
+
+    // A failed write leaves the recording truncated at the last capture
+    if (pImpl->recorder
+        && !pImpl->recorder->write(pImpl->frames, pImpl->lastHeader)) {
+        yCError(CAMERA) << "Recording stopped.";
+        pImpl->recorder->close();
+        pImpl->recorder.reset();
     }
 
-    pImpl->nLastFrameSequence = frameHeader.nFrameSequence;
+    pImpl->convert(0, image);
 
-    image.resize(pImpl->nCameraFrameWidth, pImpl->nCameraFrameHeight);
-    const uint8_t* pFrameImage = pImpl->pCameraFrameBuffer;
-    for (uint32_t y = 0; y < pImpl->nCameraFrameHeight; y++) {
-        for (uint32_t x = 0; x < pImpl->nCameraFrameWidth; x++) {
-            image.pixel(x, y).r = pFrameImage[3] > 0 ? pFrameImage[0] : 0;
-            image.pixel(x, y).g = pFrameImage[3] > 0 ? pFrameImage[1] : 0;
-            image.pixel(x, y).b = pFrameImage[3] > 0 ? pFrameImage[2] : 0;
-            pFrameImage += 4; // advance by 4 bytes (RGBA)
+    // Encoded on the worker thread of the publisher
+    if (pImpl->jpeg) {
+        pImpl->jpeg->submit(image, pImpl->lastStamp);
+    }
+
+    if (pImpl->streams) {
+        pImpl->streams->publish(pImpl->frames, pImpl->lastStamp);
+    }
+
+    // The other frame types are converted only if somebody reads them
+    for (size_t i = 1; i < pImpl->mapping.size(); ++i) {
+        auto& output = *pImpl->outputs[i - 1];
+        if (output.getOutputCount() == 0) {
+            continue;
         }
+        pImpl->convert(i, output.prepare());
+        output.setEnvelope(pImpl->lastStamp);
+        output.write();
     }
 
     return true;
@@ -230,10 +597,22 @@ bool yarp::dev::OpenVRCamera::getImage(
 
 int yarp::dev::OpenVRCamera::height() const
 {
-    return pImpl->nCameraFrameHeight;
+    if (!pImpl->mapping.empty() && pImpl->mapping.front().remap) {
+        return pImpl->remapTable.height();
+    }
+    return pImpl->source ? pImpl->source->height(0) : 0;
 }
 
 int yarp::dev::OpenVRCamera::width() const
 {
-    return pImpl->nCameraFrameWidth;
+    if (!pImpl->mapping.empty() && pImpl->mapping.front().remap) {
+        return pImpl->remapTable.width();
+    }
+    return pImpl->source ? pImpl->source->width(0) : 0;
+}
+
+yarp::os::Stamp yarp::dev::OpenVRCamera::getLastInputStamp()
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    return pImpl->lastStamp;
 }
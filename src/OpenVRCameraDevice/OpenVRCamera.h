@@ -13,6 +13,7 @@
 
 #include <yarp/dev/DeviceDriver.h>
 #include <yarp/dev/IFrameGrabberImage.h>
+#include <yarp/dev/IPreciselyTimed.h>
 
 #include <memory>
 
@@ -21,7 +22,8 @@ namespace yarp::dev {
 }
 
 class yarp::dev::OpenVRCamera : public yarp::dev::DeviceDriver,
-                                public yarp::dev::IFrameGrabberImage
+                                public yarp::dev::IFrameGrabberImage,
+                                public yarp::dev::IPreciselyTimed
 {
 public:
 
@@ -36,6 +38,9 @@ public:
     int height() const override;
     int width() const override;
 
+    // IPreciselyTimed
+    yarp::os::Stamp getLastInputStamp() override;
+
 private:
     struct Impl;
     std::unique_ptr<Impl> pImpl;
@@ -0,0 +1,18 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef YARP_OPENVR_CAMERA_LOG_COMPONENT_H
+#define YARP_OPENVR_CAMERA_LOG_COMPONENT_H
+
+#include <yarp/os/LogComponent.h>
+
+YARP_DECLARE_LOG_COMPONENT(CAMERA)
+
+#endif // YARP_OPENVR_CAMERA_LOG_COMPONENT_H
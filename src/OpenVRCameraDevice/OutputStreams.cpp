@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "OutputStreams.h"
+#include "OpenVRCameraLogComponent.h"
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/sig/Image.h>
+
+#include <algorithm>
+#include <cmath>
+
+class openvr_camera::OutputStreams::Impl
+{
+public:
+    struct Stream
+    {
+        StreamConfiguration config;
+        yarp::os::BufferedPort<yarp::sig::FlexImage> port;
+
+        // Boundaries of the box of source pixels averaged in each output
+        // pixel, and output column and row of each source column and row
+        std::vector<uint32_t> columnStart;
+        std::vector<uint32_t> rowStart;
+        std::vector<uint32_t> columnOf;
+        std::vector<uint32_t> rowOf;
+
+        // Sums of the channels of the output row being accumulated
+        std::vector<uint32_t> sums;
+
+        yarp::sig::FlexImage* image = nullptr;
+    };
+
+    std::vector<std::unique_ptr<Stream>> streams;
+
+    static void Accumulate(Stream& stream, const uint8_t* sourceRow);
+    static void Emit(Stream& stream, const uint32_t outputRow);
+};
+
+namespace {
+    // Boundaries of the boxes splitting the source size in output size
+    // parts, and the part of each source index
+    void SplitRange(const uint32_t sourceSize,
+                    const uint32_t outputSize,
+                    std::vector<uint32_t>& start,
+                    std::vector<uint32_t>& partOf)
+    {
+        start.resize(outputSize + 1);
+        for (uint32_t i = 0; i <= outputSize; ++i) {
+            start[i] = static_cast<uint32_t>(
+                static_cast<uint64_t>(i) * sourceSize / outputSize);
+        }
+
+        partOf.resize(sourceSize);
+        for (uint32_t i = 0; i < outputSize; ++i) {
+            for (uint32_t j = start[i]; j < start[i + 1]; ++j) {
+                partOf[j] = i;
+            }
+        }
+    }
+} // namespace
+
+void openvr_camera::OutputStreams::Impl::Accumulate(Stream& stream,
+                                                    const uint8_t* sourceRow)
+{
+    const uint32_t* columnOf = stream.columnOf.data();
+    uint32_t* sums = stream.sums.data();
+    const size_t width = stream.columnOf.size();
+
+    // Pixels with zero alpha are black, as in the RGB conversion
+    for (size_t x = 0; x < width; ++x, sourceRow += 4) {
+        const uint32_t mask = sourceRow[3] > 0 ? 0xFF : 0x00;
+        uint32_t* sum = sums + columnOf[x] * 3;
+        sum[0] += sourceRow[0] & mask;
+        sum[1] += sourceRow[1] & mask;
+        sum[2] += sourceRow[2] & mask;
+    }
+}
+
+void openvr_camera::OutputStreams::Impl::Emit(Stream& stream,
+                                              const uint32_t outputRow)
+{
+    const uint32_t boxHeight =
+        stream.rowStart[outputRow + 1] - stream.rowStart[outputRow];
+    uint8_t* output = stream.image->getRow(outputRow);
+    uint32_t* sums = stream.sums.data();
+
+    for (uint32_t x = 0; x < stream.config.width; ++x, sums += 3) {
+        const uint32_t count =
+            (stream.columnStart[x + 1] - stream.columnStart[x]) * boxHeight;
+        const uint32_t rounding = count / 2;
+        const uint32_t r = (sums[0] + rounding) / count;
+        const uint32_t g = (sums[1] + rounding) / count;
+        const uint32_t b = (sums[2] + rounding) / count;
+
+        switch (stream.config.format) {
+            case PixelFormat::Rgb:
+                output[0] = static_cast<uint8_t>(r);
+                output[1] = static_cast<uint8_t>(g);
+                output[2] = static_cast<uint8_t>(b);
+                output += 3;
+                break;
+            case PixelFormat::Mono:
+                // ITU-R BT.601 luma in 8-bit fixed point
+                output[0] = static_cast<uint8_t>((77 * r + 150 * g + 29 * b
+                                                  + 128)
+                                                 >> 8);
+                output += 1;
+                break;
+        }
+
+        sums[0] = sums[1] = sums[2] = 0;
+    }
+}
+
+openvr_camera::OutputStreams::OutputStreams()
+    : pImpl{std::make_unique<Impl>()}
+{}
+
+openvr_camera::OutputStreams::~OutputStreams()
+{
+    close();
+}
+
+std::optional<std::vector<openvr_camera::StreamConfiguration>>
+openvr_camera::OutputStreams::Parse(
+    const yarp::os::Value& streams,
+    const std::vector<FrameType>& frameTypes,
+    const std::vector<std::pair<uint32_t, uint32_t>>& frameSizes)
+{
+    std::vector<StreamConfiguration> configurations;
+
+    const yarp::os::Bottle* list = streams.asList();
+    if (!list) {
+        yCError(CAMERA) << "The streams entry must be a list.";
+        return std::nullopt;
+    }
+
+    for (size_t i = 0; i < list->size(); ++i) {
+        const yarp::os::Bottle* group = list->get(i).asList();
+        if (!group || !group->check("name")) {
+            yCError(CAMERA) << "Stream" << i << "has no name.";
+            return std::nullopt;
+        }
+
+        StreamConfiguration stream;
+        stream.name = group->find("name").asString();
+
+        // Try to find the "frameType" entry
+        if (group->check("frameType")) {
+            const auto type =
+                ParseFrameType(group->find("frameType").asString());
+            const auto it = type.has_value()
+                                ? std::find(frameTypes.begin(),
+                                            frameTypes.end(),
+                                            type.value())
+                                : frameTypes.end();
+            if (it == frameTypes.end()) {
+                yCError(CAMERA) << "The frame type of stream" << stream.name
+                                << "is not in frameTypes.";
+                return std::nullopt;
+            }
+            stream.frame = static_cast<size_t>(it - frameTypes.begin());
+        }
+
+        const auto [frameWidth, frameHeight] = frameSizes[stream.frame];
+
+        // Try to find the "width" and "height", or the "scale" entries
+        if (group->check("width") && group->check("height")) {
+            stream.width = group->find("width").asInt32();
+            stream.height = group->find("height").asInt32();
+        }
+        else {
+            const double scale =
+                group->check("scale") ? group->find("scale").asFloat64() : 1.0;
+            stream.width =
+                static_cast<uint32_t>(std::lround(frameWidth * scale));
+            stream.height =
+                static_cast<uint32_t>(std::lround(frameHeight * scale));
+        }
+
+        if (stream.width == 0 || stream.height == 0
+            || stream.width > frameWidth || stream.height > frameHeight) {
+            yCError(CAMERA) << "The size of stream" << stream.name
+                            << "must be positive and not larger than"
+                            << frameWidth << "x" << frameHeight;
+            return std::nullopt;
+        }
+
+        // Try to find the "format" entry
+        const std::string format =
+            group->check("format") ? group->find("format").asString() : "rgb";
+        if (format == "rgb") {
+            stream.format = PixelFormat::Rgb;
+        }
+        else if (format == "mono") {
+            stream.format = PixelFormat::Mono;
+        }
+        else {
+            yCError(CAMERA) << "Invalid format" << format << "of stream"
+                            << stream.name << "(allowed values: rgb, mono).";
+            return std::nullopt;
+        }
+
+        configurations.push_back(stream);
+    }
+
+    return configurations;
+}
+
+bool openvr_camera::OutputStreams::open(
+    const std::string& prefix,
+    const std::vector<StreamConfiguration>& streams,
+    const std::vector<std::pair<uint32_t, uint32_t>>& frameSizes)
+{
+    for (const auto& config : streams) {
+        auto stream = std::make_unique<Impl::Stream>();
+        stream->config = config;
+
+        const auto [frameWidth, frameHeight] = frameSizes[config.frame];
+        SplitRange(
+            frameWidth, config.width, stream->columnStart, stream->columnOf);
+        SplitRange(frameHeight, config.height, stream->rowStart, stream->rowOf);
+        stream->sums.assign(static_cast<size_t>(config.width) * 3, 0);
+
+        const std::string name = prefix + "/" + config.name + ":o";
+        if (!stream->port.open(name)) {
+            yCError(CAMERA) << "Failed to open the output" << name;
+            close();
+            return false;
+        }
+
+        yCInfo(CAMERA) << "Stream" << config.name << ":" << config.width
+                       << "x" << config.height
+                       << (config.format == PixelFormat::Mono ? "mono"
+                                                              : "rgb")
+                       << "on" << name;
+
+        pImpl->streams.push_back(std::move(stream));
+    }
+
+    return true;
+}
+
+void openvr_camera::OutputStreams::close()
+{
+    for (auto& stream : pImpl->streams) {
+        stream->port.close();
+    }
+    pImpl->streams.clear();
+}
+
+size_t openvr_camera::OutputStreams::readers()
+{
+    size_t readers = 0;
+    for (auto& stream : pImpl->streams) {
+        readers += stream->port.getOutputCount();
+    }
+    return readers;
+}
+
+void openvr_camera::OutputStreams::publish(const std::vector<Frame>& frames,
+                                           const yarp::os::Stamp& stamp)
+{
+    // Streams computed from each frame
+    std::vector<std::vector<Impl::Stream*>> active(frames.size());
+    for (auto& stream : pImpl->streams) {
+        if (stream->port.getOutputCount() == 0
+            || stream->config.frame >= frames.size()) {
+            continue;
+        }
+
+        const Frame& frame = frames[stream->config.frame];
+        if (frame.width != stream->columnOf.size()
+            || frame.height != stream->rowOf.size()) {
+            yCError(CAMERA) << "The size of the frame of stream"
+                            << stream->config.name << "changed.";
+            continue;
+        }
+
+        stream->image = &stream->port.prepare();
+        stream->image->setPixelCode(stream->config.format == PixelFormat::Mono
+                                        ? VOCAB_PIXEL_MONO
+                                        : VOCAB_PIXEL_RGB);
+        stream->image->resize(stream->config.width, stream->config.height);
+        active[stream->config.frame].push_back(stream.get());
+    }
+
+    // A single pass over the rows of each frame feeds all its streams
+    for (size_t f = 0; f < frames.size(); ++f) {
+        if (active[f].empty()) {
+            continue;
+        }
+
+        const Frame& frame = frames[f];
+        const size_t stride = static_cast<size_t>(frame.width) * 4;
+
+        for (uint32_t y = 0; y < frame.height; ++y) {
+            const uint8_t* sourceRow = frame.rgba.data() + y * stride;
+
+            for (Impl::Stream* stream : active[f]) {
+                Impl::Accumulate(*stream, sourceRow);
+
+                const uint32_t outputRow = stream->rowOf[y];
+                if (y + 1 == stream->rowStart[outputRow + 1]) {
+                    Impl::Emit(*stream, outputRow);
+                }
+            }
+        }
+
+        for (Impl::Stream* stream : active[f]) {
+            stream->port.setEnvelope(stamp);
+            stream->port.write();
+            stream->image = nullptr;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef YARP_OPENVR_CAMERA_OUTPUT_STREAMS_H
+#define YARP_OPENVR_CAMERA_OUTPUT_STREAMS_H
+
+#include "FrameSource.h"
+
+#include <yarp/os/Stamp.h>
+#include <yarp/os/Value.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace openvr_camera {
+    struct StreamConfiguration;
+    class OutputStreams;
+
+    enum class PixelFormat
+    {
+        Rgb,
+        Mono,
+    };
+} // namespace openvr_camera
+
+struct openvr_camera::StreamConfiguration
+{
+    std::string name;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    PixelFormat format = PixelFormat::Rgb;
+    // Index of the source frame the stream is computed from
+    size_t frame = 0;
+};
+
+// Streams of different resolutions and pixel formats computed from the
+// frames of the same capture, each published on its own port. The streams
+// computed from the same frame are produced in a single pass over it, that
+// downscales with a box filter and converts the pixel format at once.
+class openvr_camera::OutputStreams
+{
+public:
+    OutputStreams();
+    ~OutputStreams();
+
+    // Parse the "streams" entry, a list of groups like
+    // ((name thumbnail) (width 160) (height 120) (format rgb)), where the
+    // size can also be given with (scale 0.25) and the source frame with
+    // (frameType distorted)
+    static std::optional<std::vector<StreamConfiguration>>
+    Parse(const yarp::os::Value& streams,
+          const std::vector<FrameType>& frameTypes,
+          const std::vector<std::pair<uint32_t, uint32_t>>& frameSizes);
+
+    bool open(const std::string& prefix,
+              const std::vector<StreamConfiguration>& streams,
+              const std::vector<std::pair<uint32_t, uint32_t>>& frameSizes);
+    void close();
+
+    size_t readers();
+
+    // Compute and publish the streams that have readers
+    void publish(const std::vector<Frame>& frames,
+                 const yarp::os::Stamp& stamp);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+#endif // YARP_OPENVR_CAMERA_OUTPUT_STREAMS_H
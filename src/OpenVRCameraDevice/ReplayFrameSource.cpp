@@ -0,0 +1,405 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "ReplayFrameSource.h"
+#include "ConfigOptions.h"
+#include "FrameRecording.h"
+#include "MappedFile.h"
+#include "OpenVRCameraLogComponent.h"
+
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr double DefaultSpeed = 1.0;
+    // Interval assumed between the captures when it cannot be computed from
+    // the recording, the rate of the front facing camera of the Valve Index
+    constexpr double DefaultInterval = 1.0 / 54.0;
+
+    template <typename T>
+    T ReadAt(const uint8_t* data, const uint64_t offset)
+    {
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+} // namespace
+
+struct openvr_camera::ReplayFrameSource::Impl
+{
+    openvr_common::MappedFile file;
+    std::string path;
+    double speed = DefaultSpeed;
+    bool loop = true;
+
+    std::vector<FrameType> types;
+    // For every opened type, its index in the frames of the records
+    std::vector<size_t> recordedFrames;
+    std::vector<RecordingFrameType> recordedTypes;
+    std::vector<uint64_t> frameOffsets;
+    std::vector<CameraCalibration> cameras;
+
+    uint64_t dataOffset = 0;
+    uint64_t recordSize = 0;
+    uint64_t count = 0;
+
+    // Timestamps of the records, the playback repeats every loopDuration
+    // seconds with sequence numbers increased by sequenceSpan
+    std::vector<double> times;
+    double loopDuration = 0.0;
+    uint64_t sequenceSpan = 0;
+
+    bool opened = false;
+    bool streaming = false;
+    bool endReported = false;
+
+    // Position in the playback, counting the loops, of the next capture. With
+    // the original timing, it is due when the playback time, which advances
+    // by speed seconds per second from anchorPlayTime at anchorTime, reaches
+    // the one of the capture.
+    uint64_t next = 0;
+    double anchorTime = 0.0;
+    double anchorPlayTime = 0.0;
+
+    bool read();
+
+    double playTime(const uint64_t position) const
+    {
+        return times[position % count] - times.front()
+               + static_cast<double>(position / count) * loopDuration;
+    }
+
+    uint64_t recordOffset(const uint64_t position) const
+    {
+        return dataOffset + (position % count) * recordSize;
+    }
+};
+
+bool openvr_camera::ReplayFrameSource::Impl::read()
+{
+    const uint8_t* data = file.data();
+    const uint64_t size = file.size();
+
+    if (size < sizeof(RecordingFileHeader)) {
+        yCError(CAMERA) << path << "is not a camera recording.";
+        return false;
+    }
+
+    const auto header = ReadAt<RecordingFileHeader>(data, 0);
+    if (header.magic != RecordingMagic) {
+        yCError(CAMERA) << path << "is not a camera recording.";
+        return false;
+    }
+    if (header.version != RecordingVersion) {
+        yCError(CAMERA) << "Unsupported version" << header.version
+                        << "of the recording" << path;
+        return false;
+    }
+
+    uint64_t offset = sizeof(RecordingFileHeader);
+    const uint64_t entriesEnd =
+        offset + sizeof(RecordingFrameType) * uint64_t{header.typeCount}
+        + sizeof(RecordingCamera) * uint64_t{header.cameraCount};
+
+    if (header.typeCount == 0 || entriesEnd > header.dataOffset
+        || header.dataOffset > size) {
+        yCError(CAMERA) << "The recording" << path << "is corrupted.";
+        return false;
+    }
+
+    recordedTypes.clear();
+    for (uint32_t i = 0; i < header.typeCount; ++i) {
+        const auto type = ReadAt<RecordingFrameType>(data, offset);
+        offset += sizeof(RecordingFrameType);
+
+        if (type.type > static_cast<uint32_t>(FrameType::MaximumUndistorted)
+            || type.width == 0 || type.height == 0) {
+            yCError(CAMERA) << "The recording" << path << "is corrupted.";
+            return false;
+        }
+        recordedTypes.push_back(type);
+    }
+
+    cameras.clear();
+    for (uint32_t i = 0; i < header.cameraCount; ++i) {
+        const auto recorded = ReadAt<RecordingCamera>(data, offset);
+        offset += sizeof(RecordingCamera);
+
+        CameraCalibration camera;
+        camera.x = recorded.x;
+        camera.y = recorded.y;
+        camera.width = recorded.width;
+        camera.height = recorded.height;
+        camera.fx = recorded.fx;
+        camera.fy = recorded.fy;
+        camera.cx = recorded.cx;
+        camera.cy = recorded.cy;
+        camera.model = recorded.model
+                               == static_cast<uint32_t>(DistortionModel::FTheta)
+                           ? DistortionModel::FTheta
+                           : DistortionModel::None;
+        camera.coefficients = recorded.coefficients;
+        cameras.push_back(camera);
+    }
+
+    // The layout is not trusted, it must be the one of this version
+    if (RecordingLayout(recordedTypes, frameOffsets) != header.recordSize) {
+        yCError(CAMERA) << "The recording" << path << "is corrupted.";
+        return false;
+    }
+
+    dataOffset = header.dataOffset;
+    recordSize = header.recordSize;
+    count = (size - dataOffset) / recordSize;
+
+    if (count == 0) {
+        yCError(CAMERA) << "The recording" << path << "has no captures.";
+        return false;
+    }
+
+    // Map the requested types to the recorded frames
+    recordedFrames.clear();
+    for (const auto type : types) {
+        const auto it = std::find_if(
+            recordedTypes.begin(),
+            recordedTypes.end(),
+            [type](const RecordingFrameType& recorded) {
+                return recorded.type == static_cast<uint32_t>(type);
+            });
+        if (it == recordedTypes.end()) {
+            yCError(CAMERA) << "The recording" << path << "has no"
+                            << FrameTypeName(type) << "frames.";
+            return false;
+        }
+        recordedFrames.push_back(
+            static_cast<size_t>(it - recordedTypes.begin()));
+    }
+
+    times.resize(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        const auto record = ReadAt<RecordingFrameHeader>(data, recordOffset(i));
+        times[i] = record.timestamp;
+        if (i > 0 && times[i] < times[i - 1]) {
+            yCError(CAMERA) << "The timestamps of the recording" << path
+                            << "are not increasing.";
+            return false;
+        }
+    }
+
+    double interval = DefaultInterval;
+    if (count > 1 && times.back() > times.front()) {
+        interval = (times.back() - times.front()) / (count - 1);
+    }
+    loopDuration = times.back() - times.front() + interval;
+
+    const auto first = ReadAt<RecordingFrameHeader>(data, recordOffset(0));
+    const auto last =
+        ReadAt<RecordingFrameHeader>(data, recordOffset(count - 1));
+    sequenceSpan = last.sequence >= first.sequence
+                       ? uint64_t{last.sequence} - first.sequence + 1
+                       : count;
+
+    return true;
+}
+
+openvr_camera::ReplayFrameSource::ReplayFrameSource()
+    : pImpl{std::make_unique<Impl>()}
+{}
+
+openvr_camera::ReplayFrameSource::~ReplayFrameSource() = default;
+
+bool openvr_camera::ReplayFrameSource::open(
+    yarp::os::Searchable& config,
+    const std::vector<FrameType>& types)
+{
+    if (types.empty()) {
+        yCError(CAMERA) << "No frame types to stream.";
+        return false;
+    }
+    pImpl->types = types;
+
+    // Try to find the "replayFile" entry
+    if (!(config.check("replayFile") && config.find("replayFile").isString())) {
+        yCError(CAMERA) << "The replay source needs the replayFile entry.";
+        return false;
+    }
+    pImpl->path = config.find("replayFile").asString();
+
+    // Try to find the "replaySpeed" entry
+    if (!openvr_common::FindNumber(config, "replaySpeed", pImpl->speed)) {
+        yCError(CAMERA) << "The replaySpeed entry must be a number.";
+        return false;
+    }
+
+    // Try to find the "replayLoop" entry
+    if (config.check("replayLoop") && config.find("replayLoop").isBool()) {
+        pImpl->loop = config.find("replayLoop").asBool();
+    }
+
+    if (pImpl->speed < 0.0) {
+        yCError(CAMERA) << "Invalid replay speed" << pImpl->speed;
+        return false;
+    }
+
+    if (!pImpl->file.open(pImpl->path)) {
+        yCError(CAMERA) << pImpl->file.error();
+        return false;
+    }
+    if (!pImpl->read()) {
+        pImpl->file.close();
+        return false;
+    }
+
+    pImpl->next = 0;
+    pImpl->endReported = false;
+    pImpl->opened = true;
+
+    yCInfo(CAMERA) << "Replaying" << pImpl->count << "captures from"
+                   << pImpl->path << "," << pImpl->loopDuration
+                   << "s at speed" << pImpl->speed
+                   << (pImpl->speed > 0.0 ? "" : "(as fast as requested)")
+                   << (pImpl->loop ? ", looping." : ".");
+
+    return true;
+}
+
+void openvr_camera::ReplayFrameSource::close()
+{
+    stopStreaming();
+    pImpl->file.close();
+    pImpl->opened = false;
+}
+
+uint32_t openvr_camera::ReplayFrameSource::width(const size_t frame) const
+{
+    return pImpl->recordedTypes[pImpl->recordedFrames[frame]].width;
+}
+
+uint32_t openvr_camera::ReplayFrameSource::height(const size_t frame) const
+{
+    return pImpl->recordedTypes[pImpl->recordedFrames[frame]].height;
+}
+
+std::vector<openvr_camera::CameraCalibration>
+openvr_camera::ReplayFrameSource::calibration() const
+{
+    return pImpl->cameras;
+}
+
+bool openvr_camera::ReplayFrameSource::startStreaming()
+{
+    if (!pImpl->opened) {
+        return false;
+    }
+
+    // The playback resumes from where it was stopped
+    if (!pImpl->streaming) {
+        pImpl->anchorTime = yarp::os::Time::now();
+        pImpl->anchorPlayTime = pImpl->playTime(pImpl->next);
+        pImpl->file.prefetch(pImpl->recordOffset(pImpl->next),
+                             pImpl->recordSize);
+
+        yCDebug(CAMERA) << "Replay started.";
+        pImpl->streaming = true;
+    }
+    return true;
+}
+
+void openvr_camera::ReplayFrameSource::stopStreaming()
+{
+    if (pImpl->streaming) {
+        yCDebug(CAMERA) << "Replay stopped.";
+        pImpl->streaming = false;
+    }
+}
+
+bool openvr_camera::ReplayFrameSource::streaming() const
+{
+    return pImpl->streaming;
+}
+
+openvr_camera::GrabResult
+openvr_camera::ReplayFrameSource::grab(std::vector<Frame>& frames,
+                                       FrameHeader& header)
+{
+    if (!pImpl->opened) {
+        yCError(CAMERA) << "grab() called before camera has been opened.";
+        return GrabResult::Error;
+    }
+
+    startStreaming();
+
+    if (!pImpl->loop && pImpl->next >= pImpl->count) {
+        if (!pImpl->endReported) {
+            yCInfo(CAMERA) << "End of the recording reached.";
+            pImpl->endReported = true;
+        }
+        return GrabResult::NoNewFrame;
+    }
+
+    const double now = yarp::os::Time::now();
+    uint64_t position = pImpl->next;
+    double timestamp = now;
+
+    if (pImpl->speed > 0.0) {
+        const double playTime =
+            pImpl->anchorPlayTime + (now - pImpl->anchorTime) * pImpl->speed;
+        if (pImpl->playTime(position) > playTime) {
+            return GrabResult::NoNewFrame;
+        }
+
+        // As with a camera read slower than its rate, the captures due in
+        // the meantime are skipped
+        while ((pImpl->loop || position + 1 < pImpl->count)
+               && pImpl->playTime(position + 1) <= playTime) {
+            ++position;
+        }
+
+        timestamp = pImpl->anchorTime
+                    + (pImpl->playTime(position) - pImpl->anchorPlayTime)
+                          / pImpl->speed;
+    }
+
+    pImpl->next = position + 1;
+
+    const uint8_t* record =
+        pImpl->file.data() + pImpl->recordOffset(position);
+
+    frames.resize(pImpl->types.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const size_t recorded = pImpl->recordedFrames[i];
+        const RecordingFrameType& type = pImpl->recordedTypes[recorded];
+
+        frames[i].type = pImpl->types[i];
+        frames[i].width = type.width;
+        frames[i].height = type.height;
+        frames[i].rgba.assign(
+            record + pImpl->frameOffsets[recorded],
+            record + pImpl->frameOffsets[recorded]
+                + size_t{4} * type.width * type.height);
+    }
+
+    // Page in the next capture while this one is processed
+    if (pImpl->loop || pImpl->next < pImpl->count) {
+        pImpl->file.prefetch(pImpl->recordOffset(pImpl->next),
+                             pImpl->recordSize);
+    }
+
+    const auto recorded = ReadAt<RecordingFrameHeader>(record, 0);
+    header.sequence = static_cast<uint32_t>(
+        recorded.sequence + (position / pImpl->count) * pImpl->sequenceSpan);
+    header.exposureTime = recorded.exposureTime;
+    header.timestamp = timestamp;
+
+    return GrabResult::NewFrame;
+}
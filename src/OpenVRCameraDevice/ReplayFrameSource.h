@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef YARP_OPENVR_CAMERA_REPLAY_FRAME_SOURCE_H
+#define YARP_OPENVR_CAMERA_REPLAY_FRAME_SOURCE_H
+
+#include "FrameSource.h"
+
+#include <memory>
+
+namespace openvr_camera {
+    class ReplayFrameSource;
+} // namespace openvr_camera
+
+// Frames read from a recording made with FrameRecorder, memory mapped. The
+// captures are served either with their original timing, possibly scaled,
+// or one per grab() as fast as they are requested.
+class openvr_camera::ReplayFrameSource final
+    : public openvr_camera::FrameSource
+{
+public:
+    ReplayFrameSource();
+    ~ReplayFrameSource() override;
+
+    bool open(yarp::os::Searchable& config,
+              const std::vector<FrameType>& types) override;
+    void close() override;
+
+    uint32_t width(const size_t frame) const override;
+    uint32_t height(const size_t frame) const override;
+    std::vector<CameraCalibration> calibration() const override;
+
+    bool startStreaming() override;
+    void stopStreaming() override;
+    bool streaming() const override;
+
+    GrabResult grab(std::vector<Frame>& frames, FrameHeader& header) override;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+#endif // YARP_OPENVR_CAMERA_REPLAY_FRAME_SOURCE_H
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "SyntheticFrameSource.h"
+#include "ConfigOptions.h"
+#include "OpenVRCameraLogComponent.h"
+
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Resolution and rate of the front facing camera of the Valve Index
+    constexpr uint32_t DefaultWidth = 960;
+    constexpr uint32_t DefaultHeight = 960;
+    constexpr double DefaultFps = 54.0;
+    constexpr double Pi = 3.14159265358979323846;
+
+    // Stateless hash of the frame index, used to decide which frames are
+    // dropped independently of the rate at which the source is polled
+    double DropSample(uint64_t index)
+    {
+        // splitmix64 finalizer
+        uint64_t z = index + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z = z ^ (z >> 31);
+        return static_cast<double>(z >> 11) * 0x1.0p-53;
+    }
+} // namespace
+
+struct openvr_camera::SyntheticFrameSource::Impl
+{
+    uint32_t width = DefaultWidth;
+    uint32_t height = DefaultHeight;
+    double fps = DefaultFps;
+    double dropRate = 0.0;
+    std::vector<FrameType> types;
+
+    double startTime = 0.0;
+    uint64_t lastFrameIndex = 0;
+    bool opened = false;
+    bool streaming = false;
+
+    // For every row, the first and last column inside the lens circle. As in
+    // the undistorted frames of the runtime, pixels outside of it have a zero
+    // alpha channel.
+    std::vector<std::pair<uint32_t, uint32_t>> validColumns;
+
+    void draw(uint64_t index, Frame& frame) const;
+};
+
+void openvr_camera::SyntheticFrameSource::Impl::draw(uint64_t index,
+                                                     Frame& frame) const
+{
+    frame.width = width;
+    frame.height = height;
+    frame.rgba.resize(static_cast<size_t>(width) * height * 4);
+
+    // Diagonal gradient scrolling by one pixel per frame
+    const auto shift = static_cast<uint8_t>(index);
+    uint8_t* row = frame.rgba.data();
+
+    // Only the undistorted frames are masked by the lens circle
+    const bool masked = frame.type != FrameType::Distorted;
+
+    for (uint32_t y = 0; y < height; ++y, row += width * 4) {
+        const auto [first, last] =
+            masked ? validColumns[y] : std::make_pair(0u, width - 1);
+        for (uint32_t x = 0; x < width; ++x) {
+            uint8_t* pixel = row + x * 4;
+            pixel[0] = static_cast<uint8_t>(x + shift);
+            pixel[1] = static_cast<uint8_t>(y + shift);
+            pixel[2] = static_cast<uint8_t>(x + y);
+            pixel[3] = (x >= first && x <= last) ? 255 : 0;
+        }
+    }
+}
+
+openvr_camera::SyntheticFrameSource::SyntheticFrameSource()
+    : pImpl{std::make_unique<Impl>()}
+{}
+
+openvr_camera::SyntheticFrameSource::~SyntheticFrameSource() = default;
+
+bool openvr_camera::SyntheticFrameSource::open(
+    yarp::os::Searchable& config,
+    const std::vector<FrameType>& types)
+{
+    if (types.empty()) {
+        yCError(CAMERA) << "No frame types to stream.";
+        return false;
+    }
+    pImpl->types = types;
+
+    // Try to find the "syntheticWidth" entry
+    if (config.check("syntheticWidth")
+        && config.find("syntheticWidth").isInt32()) {
+        pImpl->width = config.find("syntheticWidth").asInt32();
+    }
+
+    // Try to find the "syntheticHeight" entry
+    if (config.check("syntheticHeight")
+        && config.find("syntheticHeight").isInt32()) {
+        pImpl->height = config.find("syntheticHeight").asInt32();
+    }
+
+    // Try to find the "syntheticFps" and "syntheticDropRate" entries
+    if (!(openvr_common::FindNumber(config, "syntheticFps", pImpl->fps)
+          && openvr_common::FindNumber(
+              config, "syntheticDropRate", pImpl->dropRate))) {
+        yCError(CAMERA) << "The syntheticFps and syntheticDropRate entries"
+                        << "must be numbers.";
+        return false;
+    }
+
+    if (pImpl->width == 0 || pImpl->height == 0 || pImpl->fps <= 0.0
+        || pImpl->dropRate < 0.0 || pImpl->dropRate >= 1.0) {
+        yCError(CAMERA) << "Invalid synthetic source configuration:"
+                        << pImpl->width << "x" << pImpl->height << "at"
+                        << pImpl->fps << "fps, drop rate" << pImpl->dropRate;
+        return false;
+    }
+
+    const double cx = 0.5 * pImpl->width;
+    const double cy = 0.5 * pImpl->height;
+    const double radius = 0.5 * std::max(pImpl->width, pImpl->height);
+
+    pImpl->validColumns.resize(pImpl->height);
+    for (uint32_t y = 0; y < pImpl->height; ++y) {
+        const double dy = y + 0.5 - cy;
+        const double dx = std::sqrt(std::max(0.0, radius * radius - dy * dy));
+        const double first = std::max(0.0, std::ceil(cx - dx));
+        const double last = std::min(pImpl->width - 1.0, std::floor(cx + dx));
+        pImpl->validColumns[y] = {static_cast<uint32_t>(first),
+                                  static_cast<uint32_t>(last)};
+    }
+
+    pImpl->startTime = yarp::os::Time::now();
+    pImpl->lastFrameIndex = 0;
+    pImpl->opened = true;
+
+    yCInfo(CAMERA) << "Synthetic source:" << pImpl->width << "x"
+                   << pImpl->height << "at" << pImpl->fps
+                   << "fps, drop rate" << pImpl->dropRate;
+
+    return true;
+}
+
+void openvr_camera::SyntheticFrameSource::close()
+{
+    stopStreaming();
+    pImpl->opened = false;
+}
+
+uint32_t
+openvr_camera::SyntheticFrameSource::width(const size_t /*frame*/) const
+{
+    return pImpl->width;
+}
+
+uint32_t
+openvr_camera::SyntheticFrameSource::height(const size_t /*frame*/) const
+{
+    return pImpl->height;
+}
+
+std::vector<openvr_camera::CameraCalibration>
+openvr_camera::SyntheticFrameSource::calibration() const
+{
+    // A single equidistant fisheye covering 180 degrees on the shorter side
+    CameraCalibration camera;
+    camera.width = pImpl->width;
+    camera.height = pImpl->height;
+    camera.fx = std::min(pImpl->width, pImpl->height) / Pi;
+    camera.fy = camera.fx;
+    camera.cx = 0.5 * pImpl->width;
+    camera.cy = 0.5 * pImpl->height;
+    camera.model = DistortionModel::FTheta;
+
+    return {camera};
+}
+
+bool openvr_camera::SyntheticFrameSource::startStreaming()
+{
+    if (!pImpl->opened) {
+        return false;
+    }
+
+    if (!pImpl->streaming) {
+        yCDebug(CAMERA) << "Synthetic streaming started.";
+        pImpl->streaming = true;
+    }
+    return true;
+}
+
+void openvr_camera::SyntheticFrameSource::stopStreaming()
+{
+    if (pImpl->streaming) {
+        yCDebug(CAMERA) << "Synthetic streaming stopped.";
+        pImpl->streaming = false;
+    }
+}
+
+bool openvr_camera::SyntheticFrameSource::streaming() const
+{
+    return pImpl->streaming;
+}
+
+openvr_camera::GrabResult
+openvr_camera::SyntheticFrameSource::grab(std::vector<Frame>& frames,
+                                          FrameHeader& header)
+{
+    if (!pImpl->opened) {
+        yCError(CAMERA) << "grab() called before camera has been opened.";
+        return GrabResult::Error;
+    }
+
+    // The camera keeps running while not streaming, the frames exposed in
+    // the meantime are skipped
+    startStreaming();
+
+    // Index of the latest frame exposed by the free-running camera. Frame 0
+    // is exposed at open time and is never delivered, so that sequence
+    // numbers start from 1 as in the runtime.
+    const double elapsed = yarp::os::Time::now() - pImpl->startTime;
+    uint64_t index = static_cast<uint64_t>(elapsed * pImpl->fps);
+
+    // A dropped frame never reaches the reader, which keeps getting the
+    // previous one until the next frame is exposed
+    while (index > pImpl->lastFrameIndex
+           && DropSample(index) < pImpl->dropRate) {
+        --index;
+    }
+
+    if (index <= pImpl->lastFrameIndex) {
+        return GrabResult::NoNewFrame;
+    }
+
+    pImpl->lastFrameIndex = index;
+
+    frames.resize(pImpl->types.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        frames[i].type = pImpl->types[i];
+        pImpl->draw(index, frames[i]);
+    }
+
+    const double exposure = index / pImpl->fps;
+    header.sequence = static_cast<uint32_t>(index);
+    header.exposureTime = static_cast<uint64_t>(exposure * 1e6);
+    header.timestamp = pImpl->startTime + exposure;
+
+    return GrabResult::NewFrame;
+}
@@ -0,0 +1,408 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "TrackedCameraSession.h"
+#include "OpenVRCameraLogComponent.h"
+
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+
+namespace {
+    // The header of the latest capture is cheap to read, the cameras run at
+    // 60 fps at most
+    constexpr auto PollPeriod = std::chrono::milliseconds(2);
+
+    std::mutex SessionMutex;
+    std::weak_ptr<openvr_camera::TrackedCameraSession> Session;
+} // namespace
+
+struct openvr_camera::TrackedCameraSession::Impl
+{
+    vr::IVRSystem* pVRSystem = nullptr;
+    vr::IVRTrackedCamera* pVRTrackedCamera = nullptr;
+
+    std::vector<std::shared_ptr<CameraStream>> streams;
+
+    std::thread poller;
+    bool stopPoller = false;
+    std::condition_variable pollerWakeUp;
+
+    // Protects the list of streams and the handles, shared by the poller and
+    // the sources. It is not held during the copies of the frames.
+    mutable std::mutex mutex;
+
+    void pollLoop();
+    void poll(CameraStream& stream) const;
+    vr::EVRTrackedCameraError
+    readFrame(const CameraStream& stream,
+              const size_t i,
+              Frame& frame,
+              vr::CameraVideoStreamFrameHeader_t& frameHeader) const;
+
+    bool anyStreaming() const
+    {
+        return std::any_of(streams.begin(), streams.end(), [](const auto& s) {
+            return s->handle != INVALID_TRACKED_CAMERA_HANDLE;
+        });
+    }
+};
+
+void openvr_camera::TrackedCameraSession::Impl::pollLoop()
+{
+    std::vector<std::shared_ptr<CameraStream>> polled;
+    auto lock = std::unique_lock(mutex);
+
+    while (!stopPoller) {
+        if (!anyStreaming()) {
+            pollerWakeUp.wait(lock,
+                              [this] { return stopPoller || anyStreaming(); });
+            continue;
+        }
+
+        // Each stream is polled under its own lock, so that the sources only
+        // wait for the copies of their camera when they stop streaming
+        polled = streams;
+        lock.unlock();
+
+        for (const auto& stream : polled) {
+            const auto pollLock = std::unique_lock(stream->pollMutex);
+            if (stream->handle != INVALID_TRACKED_CAMERA_HANDLE) {
+                poll(*stream);
+            }
+        }
+        polled.clear();
+
+        lock.lock();
+        pollerWakeUp.wait_for(lock, PollPeriod, [this] { return stopPoller; });
+    }
+}
+
+vr::EVRTrackedCameraError
+openvr_camera::TrackedCameraSession::Impl::readFrame(
+    const CameraStream& stream,
+    const size_t i,
+    Frame& frame,
+    vr::CameraVideoStreamFrameHeader_t& frameHeader) const
+{
+    const auto& requirements = stream.frames[i];
+    frame.type = requirements.type;
+    frame.width = requirements.width;
+    frame.height = requirements.height;
+    frame.rgba.resize(requirements.bufferSize);
+
+    return pVRTrackedCamera->GetVideoStreamFrameBuffer(
+        stream.handle,
+        vr::EVRTrackedCameraFrameType(requirements.type),
+        frame.rgba.data(),
+        requirements.bufferSize,
+        &frameHeader,
+        sizeof(frameHeader));
+}
+
+void openvr_camera::TrackedCameraSession::Impl::poll(
+    CameraStream& stream) const
+{
+    // The errors are reported once, the stream is polled until it recovers
+    // or is stopped
+    const auto fail = [this, &stream](const char* what,
+                                      const vr::EVRTrackedCameraError error) {
+        const auto lock = std::unique_lock(stream.mutex);
+        if (!stream.failed) {
+            yCError(CAMERA)
+                << "GetVideoStreamFrameBuffer() Failed to get" << what
+                << "of device" << stream.device << ". Error:"
+                << pVRTrackedCamera->GetCameraErrorNameFromEnum(error);
+        }
+        stream.failed = true;
+    };
+
+    // get the frame header only
+    vr::CameraVideoStreamFrameHeader_t frameHeader;
+    vr::EVRTrackedCameraError nCameraError =
+        pVRTrackedCamera->GetVideoStreamFrameBuffer(
+            stream.handle,
+            vr::EVRTrackedCameraFrameType(stream.frames.front().type),
+            nullptr,
+            0,
+            &frameHeader,
+            sizeof(frameHeader));
+
+    if (nCameraError != vr::VRTrackedCameraError_None) {
+        fail("frame header", nCameraError);
+        return;
+    }
+
+    if (frameHeader.nFrameSequence == stream.lastSequence) {
+        return;
+    }
+
+    // Frame has changed, do the more expensive frame buffer copies. A new
+    // capture can arrive between the copies of the different types, in
+    // that case all the types are copied again from the newer capture.
+    constexpr size_t MaxAttempts = 3;
+    stream.back.resize(stream.frames.size());
+
+    for (size_t attempt = 0; attempt < MaxAttempts; ++attempt) {
+        nCameraError = readFrame(stream, 0, stream.back[0], frameHeader);
+        if (nCameraError != vr::VRTrackedCameraError_None) {
+            fail("frame buffer", nCameraError);
+            return;
+        }
+
+        bool consistent = true;
+        for (size_t i = 1; i < stream.frames.size() && consistent; ++i) {
+            vr::CameraVideoStreamFrameHeader_t otherHeader;
+            nCameraError = readFrame(stream, i, stream.back[i], otherHeader);
+            if (nCameraError != vr::VRTrackedCameraError_None) {
+                fail("frame buffer", nCameraError);
+                return;
+            }
+            consistent = otherHeader.nFrameSequence
+                         == frameHeader.nFrameSequence;
+        }
+
+        if (consistent) {
+            stream.lastSequence = frameHeader.nFrameSequence;
+
+            const auto lock = std::unique_lock(stream.mutex);
+            stream.latest.swap(stream.back);
+            stream.latestHeader.sequence = frameHeader.nFrameSequence;
+            stream.latestHeader.exposureTime = frameHeader.ulFrameExposureTime;
+            stream.latestHeader.timestamp = yarp::os::Time::now();
+            stream.fresh = true;
+            stream.failed = false;
+            return;
+        }
+    }
+
+    yCWarning(CAMERA) << "Failed to read all the frame types from the same"
+                      << "capture.";
+}
+
+// ====================
+// TrackedCameraSession
+// ====================
+
+openvr_camera::TrackedCameraSession::TrackedCameraSession()
+    : pImpl{std::make_unique<Impl>()}
+{}
+
+openvr_camera::TrackedCameraSession::~TrackedCameraSession()
+{
+    if (pImpl->poller.joinable()) {
+        {
+            const auto lock = std::unique_lock(pImpl->mutex);
+            pImpl->stopPoller = true;
+        }
+        pImpl->pollerWakeUp.notify_all();
+        pImpl->poller.join();
+    }
+
+    if (pImpl->pVRSystem) {
+        yCInfo(CAMERA) << "Shutting down OpenVR.";
+        vr::VR_Shutdown();
+    }
+}
+
+std::shared_ptr<openvr_camera::TrackedCameraSession>
+openvr_camera::TrackedCameraSession::acquire()
+{
+    const auto lock = std::unique_lock(SessionMutex);
+
+    if (auto session = Session.lock()) {
+        return session;
+    }
+
+    // Loading the SteamVR Runtime
+    yCInfo(CAMERA) << "Starting OpenVR...";
+    std::shared_ptr<TrackedCameraSession> session(new TrackedCameraSession);
+
+    vr::EVRInitError eError = vr::VRInitError_None;
+    vr::IVRSystem* system = vr::VR_Init(&eError, vr::VRApplication_Scene);
+    if (eError != vr::VRInitError_None) {
+        yCError(CAMERA) << "Unable to init VR runtime:"
+                        << vr::VR_GetVRInitErrorAsSymbol(eError);
+        return nullptr;
+    }
+    session->pImpl->pVRSystem = system;
+
+    session->pImpl->pVRTrackedCamera = vr::VRTrackedCamera();
+    if (!session->pImpl->pVRTrackedCamera) {
+        yCError(CAMERA) << "Unable to get Tracked Camera interface.";
+        return nullptr;
+    }
+
+    session->pImpl->poller =
+        std::thread([impl = session->pImpl.get()] { impl->pollLoop(); });
+
+    Session = session;
+    return session;
+}
+
+vr::IVRSystem* openvr_camera::TrackedCameraSession::system() const
+{
+    return pImpl->pVRSystem;
+}
+
+vr::IVRTrackedCamera* openvr_camera::TrackedCameraSession::trackedCamera() const
+{
+    return pImpl->pVRTrackedCamera;
+}
+
+std::optional<vr::TrackedDeviceIndex_t>
+openvr_camera::TrackedCameraSession::findBySerial(
+    const std::string& serialNumber) const
+{
+    for (vr::TrackedDeviceIndex_t index = 0;
+         index < vr::k_unMaxTrackedDeviceCount;
+         ++index) {
+        if (!pImpl->pVRSystem->IsTrackedDeviceConnected(index)) {
+            continue;
+        }
+
+        char buffer[vr::k_unMaxPropertyStringSize];
+        pImpl->pVRSystem->GetStringTrackedDeviceProperty(
+            index, vr::Prop_SerialNumber_String, buffer, sizeof(buffer));
+        if (serialNumber == buffer) {
+            return index;
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<vr::TrackedDeviceIndex_t>
+openvr_camera::TrackedCameraSession::findByRole(const std::string& role) const
+{
+    vr::TrackedDeviceIndex_t index = vr::k_unTrackedDeviceIndexInvalid;
+
+    if (role == "hmd") {
+        index = vr::k_unTrackedDeviceIndex_Hmd;
+    }
+    else if (role == "left") {
+        index = pImpl->pVRSystem->GetTrackedDeviceIndexForControllerRole(
+            vr::TrackedControllerRole_LeftHand);
+    }
+    else if (role == "right") {
+        index = pImpl->pVRSystem->GetTrackedDeviceIndexForControllerRole(
+            vr::TrackedControllerRole_RightHand);
+    }
+
+    if (index == vr::k_unTrackedDeviceIndexInvalid
+        || !pImpl->pVRSystem->IsTrackedDeviceConnected(index)) {
+        return std::nullopt;
+    }
+
+    return index;
+}
+
+void openvr_camera::TrackedCameraSession::add(
+    const std::shared_ptr<CameraStream>& stream)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->streams.push_back(stream);
+}
+
+void openvr_camera::TrackedCameraSession::remove(
+    const std::shared_ptr<CameraStream>& stream)
+{
+    stopStreaming(*stream);
+
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->streams.erase(
+        std::remove(pImpl->streams.begin(), pImpl->streams.end(), stream),
+        pImpl->streams.end());
+}
+
+bool openvr_camera::TrackedCameraSession::startStreaming(CameraStream& stream)
+{
+    {
+        const auto pollLock = std::unique_lock(stream.pollMutex);
+        const auto lock = std::unique_lock(pImpl->mutex);
+
+        if (stream.handle != INVALID_TRACKED_CAMERA_HANDLE) {
+            return true;
+        }
+
+        pImpl->pVRTrackedCamera->AcquireVideoStreamingService(stream.device,
+                                                              &stream.handle);
+        if (stream.handle == INVALID_TRACKED_CAMERA_HANDLE) {
+            yCError(CAMERA) << "AcquireVideoStreamingService() Failed!";
+            return false;
+        }
+
+        // The sequence of the new handle is unrelated to the one of the
+        // previous acquisition: a capture with the same number as the last
+        // one read before the release must not be skipped
+        stream.lastSequence = 0;
+    }
+
+    pImpl->pollerWakeUp.notify_all();
+
+    yCInfo(CAMERA) << "Video streaming service of device" << stream.device
+                   << "acquired.";
+    return true;
+}
+
+void openvr_camera::TrackedCameraSession::stopStreaming(CameraStream& stream)
+{
+    {
+        // Wait for the copy of the current capture, if any
+        const auto pollLock = std::unique_lock(stream.pollMutex);
+        const auto lock = std::unique_lock(pImpl->mutex);
+
+        if (stream.handle == INVALID_TRACKED_CAMERA_HANDLE) {
+            return;
+        }
+
+        pImpl->pVRTrackedCamera->ReleaseVideoStreamingService(stream.handle);
+        stream.handle = INVALID_TRACKED_CAMERA_HANDLE;
+        stream.lastSequence = 0;
+    }
+
+    {
+        const auto lock = std::unique_lock(stream.mutex);
+        stream.fresh = false;
+        stream.failed = false;
+    }
+
+    yCInfo(CAMERA) << "Video streaming service of device" << stream.device
+                   << "released.";
+}
+
+bool openvr_camera::TrackedCameraSession::streaming(
+    const CameraStream& stream) const
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    return stream.handle != INVALID_TRACKED_CAMERA_HANDLE;
+}
+
+openvr_camera::GrabResult
+openvr_camera::TrackedCameraSession::take(CameraStream& stream,
+                                          std::vector<Frame>& frames,
+                                          FrameHeader& header)
+{
+    const auto lock = std::unique_lock(stream.mutex);
+
+    if (stream.fresh) {
+        // The frames of the caller are reused by the next capture
+        frames.swap(stream.latest);
+        header = stream.latestHeader;
+        stream.fresh = false;
+        return GrabResult::NewFrame;
+    }
+
+    return stream.failed ? GrabResult::Error : GrabResult::NoNewFrame;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef YARP_OPENVR_CAMERA_TRACKED_CAMERA_SESSION_H
+#define YARP_OPENVR_CAMERA_TRACKED_CAMERA_SESSION_H
+
+#include "FrameSource.h"
+
+#include <openvr.h>
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace openvr_camera {
+    struct CameraStream;
+    class TrackedCameraSession;
+} // namespace openvr_camera
+
+// Frames of the camera of a tracked device, captured by the polling thread
+// of the session
+struct openvr_camera::CameraStream
+{
+    vr::TrackedDeviceIndex_t device = vr::k_unTrackedDeviceIndex_Hmd;
+
+    // Frame types read from the streaming handle, and their requirements
+    struct FrameRequirements
+    {
+        FrameType type;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t bufferSize = 0;
+    };
+    std::vector<FrameRequirements> frames;
+
+    // Held by the poller while copying the frames of this stream. The
+    // handle is changed holding both this and the mutex of the session, and
+    // the other fields are used only under this lock.
+    std::mutex pollMutex;
+    vr::TrackedCameraHandle_t handle = INVALID_TRACKED_CAMERA_HANDLE;
+    uint32_t lastSequence = 0;
+    std::vector<Frame> back;
+
+    // Latest capture, swapped with the frames of the reader
+    std::mutex mutex;
+    std::vector<Frame> latest;
+    FrameHeader latestHeader;
+    bool fresh = false;
+    bool failed = false;
+};
+
+// Runtime session shared by all the tracked camera sources of the process.
+// A single thread polls the cameras that are streaming and copies their new
+// captures, that are then taken by the sources without calling the runtime.
+class openvr_camera::TrackedCameraSession
+{
+public:
+    // The session is initialized by the first call, and shut down when the
+    // last reference is released. It returns nullptr if the runtime cannot
+    // be initialized.
+    static std::shared_ptr<TrackedCameraSession> acquire();
+    ~TrackedCameraSession();
+
+    vr::IVRSystem* system() const;
+    vr::IVRTrackedCamera* trackedCamera() const;
+
+    // Index of the connected device with the given serial number, or with
+    // the given role (hmd, left, right)
+    std::optional<vr::TrackedDeviceIndex_t>
+    findBySerial(const std::string& serialNumber) const;
+    std::optional<vr::TrackedDeviceIndex_t>
+    findByRole(const std::string& role) const;
+
+    // The streams are polled only while streaming
+    void add(const std::shared_ptr<CameraStream>& stream);
+    void remove(const std::shared_ptr<CameraStream>& stream);
+
+    bool startStreaming(CameraStream& stream);
+    void stopStreaming(CameraStream& stream);
+    bool streaming(const CameraStream& stream) const;
+
+    // Move the latest capture of the stream in the frames, if not taken yet
+    GrabResult take(CameraStream& stream,
+                    std::vector<Frame>& frames,
+                    FrameHeader& header);
+
+private:
+    TrackedCameraSession();
+
+    struct Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+#endif // YARP_OPENVR_CAMERA_TRACKED_CAMERA_SESSION_H
@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "TrackedCameraSource.h"
+#include "OpenVRCameraLogComponent.h"
+#include "TrackedCameraSession.h"
+
+#include <yarp/os/LogStream.h>
+
+#include <openvr.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <optional>
+
+// Adapted from
+// https://github.com/ValveSoftware/openvr/blob/91825305130f446f82054c1ec3d416321ace0072/samples/tracked_camera_openvr_sample/tracked_camera_openvr_sample.cpp
+
+struct openvr_camera::TrackedCameraSource::Impl
+{
+    std::shared_ptr<TrackedCameraSession> session;
+    vr::IVRSystem* pVRSystem = nullptr;
+    vr::IVRTrackedCamera* pVRTrackedCamera = nullptr;
+
+    // Captures of the camera, polled by the session
+    std::shared_ptr<CameraStream> stream;
+
+    std::string serialNumber;
+
+    std::vector<CameraCalibration> cameras;
+
+    void readCalibration();
+};
+
+void openvr_camera::TrackedCameraSource::Impl::readCalibration()
+{
+    cameras.clear();
+    const vr::TrackedDeviceIndex_t device = stream->device;
+
+    uint32_t frameWidth = 0;
+    uint32_t frameHeight = 0;
+    uint32_t frameBufferSize = 0;
+    if (pVRTrackedCamera->GetCameraFrameSize(
+            device,
+            vr::VRTrackedCameraFrameType_Distorted,
+            &frameWidth,
+            &frameHeight,
+            &frameBufferSize)
+        != vr::VRTrackedCameraError_None) {
+        yCWarning(CAMERA) << "Unable to get the size of the distorted frames.";
+        return;
+    }
+
+    vr::ETrackedPropertyError propertyError;
+    int32_t numCameras = pVRSystem->GetInt32TrackedDeviceProperty(
+        device,
+        vr::Prop_NumCameras_Int32,
+        &propertyError);
+    if (propertyError != vr::TrackedProp_Success || numCameras < 1) {
+        numCameras = 1;
+    }
+    numCameras = std::min(numCameras, static_cast<int32_t>(vr::k_unMaxCameras));
+
+    const int32_t layout = pVRSystem->GetInt32TrackedDeviceProperty(
+        device,
+        vr::Prop_CameraFrameLayout_Int32,
+        &propertyError);
+    const bool horizontal =
+        propertyError == vr::TrackedProp_Success
+        && (layout & vr::EVRTrackedCameraFrameLayout_HorizontalLayout);
+
+    std::array<int32_t, vr::k_unMaxCameras> functions = {};
+    pVRSystem->GetArrayTrackedDeviceProperty(
+        device,
+        vr::Prop_CameraDistortionFunction_Int32_Array,
+        vr::k_unInt32PropertyTag,
+        functions.data(),
+        sizeof(functions),
+        &propertyError);
+    if (propertyError != vr::TrackedProp_Success) {
+        functions.fill(vr::VRDistortionFunctionType_None);
+    }
+
+    std::array<float,
+               vr::k_unMaxCameras * vr::k_unMaxDistortionFunctionParameters>
+        coefficients = {};
+    pVRSystem->GetArrayTrackedDeviceProperty(
+        device,
+        vr::Prop_CameraDistortionCoefficients_Float_Array,
+        vr::k_unFloatPropertyTag,
+        coefficients.data(),
+        sizeof(coefficients),
+        &propertyError);
+    if (propertyError != vr::TrackedProp_Success) {
+        coefficients.fill(0.0f);
+    }
+
+    for (int32_t i = 0; i < numCameras; ++i) {
+        CameraCalibration camera;
+
+        // The images of the cameras are stacked in the frame
+        if (horizontal) {
+            camera.width = frameWidth / numCameras;
+            camera.height = frameHeight;
+            camera.x = i * camera.width;
+        }
+        else {
+            camera.width = frameWidth;
+            camera.height = frameHeight / numCameras;
+            camera.y = i * camera.height;
+        }
+
+        vr::HmdVector2_t focalLength;
+        vr::HmdVector2_t center;
+        if (pVRTrackedCamera->GetCameraIntrinsics(
+                device,
+                i,
+                vr::VRTrackedCameraFrameType_Distorted,
+                &focalLength,
+                &center)
+            != vr::VRTrackedCameraError_None) {
+            yCWarning(CAMERA) << "Unable to get the intrinsics of camera" << i;
+            cameras.clear();
+            return;
+        }
+
+        camera.fx = focalLength.v[0];
+        camera.fy = focalLength.v[1];
+        camera.cx = center.v[0];
+        camera.cy = center.v[1];
+
+        switch (functions[i]) {
+            case vr::VRDistortionFunctionType_None:
+                camera.model = DistortionModel::None;
+                break;
+            case vr::VRDistortionFunctionType_FTheta:
+                camera.model = DistortionModel::FTheta;
+                break;
+            default:
+                // The extended model adds terms that are neglected
+                yCWarning(CAMERA) << "Distortion function" << functions[i]
+                                  << "of camera" << i
+                                  << "approximated with the f-theta model.";
+                camera.model = DistortionModel::FTheta;
+                break;
+        }
+
+        for (size_t k = 0; k < camera.coefficients.size(); ++k) {
+            camera.coefficients[k] =
+                coefficients[i * vr::k_unMaxDistortionFunctionParameters + k];
+        }
+
+        cameras.push_back(camera);
+    }
+}
+
+openvr_camera::TrackedCameraSource::TrackedCameraSource()
+    : pImpl{std::make_unique<Impl>()}
+{}
+
+openvr_camera::TrackedCameraSource::~TrackedCameraSource()
+{
+    close();
+}
+
+bool openvr_camera::TrackedCameraSource::open(
+    yarp::os::Searchable& config,
+    const std::vector<FrameType>& types)
+{
+    if (types.empty()) {
+        yCError(CAMERA) << "No frame types to stream.";
+        return false;
+    }
+
+    // The runtime is shared by all the cameras of the process
+    pImpl->session = TrackedCameraSession::acquire();
+    if (!pImpl->session) {
+        return false;
+    }
+    pImpl->pVRSystem = pImpl->session->system();
+    pImpl->pVRTrackedCamera = pImpl->session->trackedCamera();
+
+    // Select the device of the camera, by default the HMD
+    pImpl->stream = std::make_shared<CameraStream>();
+    std::optional<vr::TrackedDeviceIndex_t> device =
+        vr::k_unTrackedDeviceIndex_Hmd;
+    // Any value is taken as text, e.g. a numeric serial number parsed as an
+    // integer, rather than silently opening the camera of the HMD
+    if (config.check("cameraSerial") && config.check("cameraRole")) {
+        yCError(CAMERA)
+            << "Only one of cameraSerial and cameraRole can be set.";
+        return false;
+    }
+    if (config.check("cameraSerial")) {
+        const std::string serial = config.find("cameraSerial").toString();
+        device = pImpl->session->findBySerial(serial);
+        if (!device) {
+            yCError(CAMERA) << "No device connected with serial number"
+                            << serial;
+            return false;
+        }
+    }
+    else if (config.check("cameraRole")) {
+        std::string role = config.find("cameraRole").toString();
+        std::transform(role.begin(), role.end(), role.begin(), ::tolower);
+        device = pImpl->session->findByRole(role);
+        if (!device) {
+            yCError(CAMERA) << "No device connected with role" << role
+                            << "(allowed values: hmd, left, right).";
+            return false;
+        }
+    }
+    pImpl->stream->device = device.value();
+
+    char systemName[1024];
+    char serialNumber[1024];
+    pImpl->pVRSystem->GetStringTrackedDeviceProperty(
+        pImpl->stream->device,
+        vr::Prop_TrackingSystemName_String,
+        systemName,
+        sizeof(systemName));
+    pImpl->pVRSystem->GetStringTrackedDeviceProperty(
+        pImpl->stream->device,
+        vr::Prop_SerialNumber_String,
+        serialNumber,
+        sizeof(serialNumber));
+
+    pImpl->serialNumber = serialNumber;
+
+    yCInfo(CAMERA) << "VR device" << pImpl->stream->device << ":" << systemName
+                   << serialNumber;
+
+    bool bHasCamera = false;
+    vr::EVRTrackedCameraError nCameraError = pImpl->pVRTrackedCamera->HasCamera(
+        pImpl->stream->device, &bHasCamera);
+
+    if (nCameraError != vr::VRTrackedCameraError_None || !bHasCamera) {
+        yCError(CAMERA) << "No Tracked Camera Available:"
+                        << pImpl->pVRTrackedCamera->GetCameraErrorNameFromEnum(
+                               nCameraError);
+        return false;
+    }
+
+    // Accessing the FW description is just a further check to ensure camera
+    // communication is valid as expected.
+    vr::ETrackedPropertyError propertyError;
+    char buffer[128];
+    pImpl->pVRSystem->GetStringTrackedDeviceProperty(
+        pImpl->stream->device,
+        vr::Prop_CameraFirmwareDescription_String,
+        buffer,
+        sizeof(buffer),
+        &propertyError);
+    if (propertyError != vr::TrackedProp_Success) {
+        yCError(CAMERA) << "Unable to get Tracked Camera Firmware Description:"
+                        << pImpl->pVRSystem->GetPropErrorNameFromEnum(
+                               propertyError);
+
+        return false;
+    }
+
+    yCInfo(CAMERA) << "Camera FW Description:" << buffer;
+
+    yCInfo(CAMERA) << "Starting video acquisition...";
+
+    // Get the camera frame buffer requirements of all the frame types
+    for (const auto type : types) {
+        CameraStream::FrameRequirements requirements{type};
+        auto error = pImpl->pVRTrackedCamera->GetCameraFrameSize(
+            pImpl->stream->device,
+            vr::EVRTrackedCameraFrameType(type),
+            &requirements.width,
+            &requirements.height,
+            &requirements.bufferSize);
+        if (error != vr::VRTrackedCameraError_None) {
+            yCError(CAMERA) << "GetCameraFrameBounds() Failed for"
+                            << FrameTypeName(type) << "frames!";
+            return false;
+        }
+
+        yCInfo(CAMERA) << "Streaming" << FrameTypeName(type) << "frames:"
+                       << requirements.width << "x" << requirements.height;
+        pImpl->stream->frames.push_back(requirements);
+    }
+
+    pImpl->readCalibration();
+
+    // The streaming service is acquired when the frames are first needed,
+    // then the captures are polled by the session
+    pImpl->session->add(pImpl->stream);
+    return true;
+}
+
+void openvr_camera::TrackedCameraSource::close()
+{
+    if (pImpl->session && pImpl->stream) {
+        pImpl->session->remove(pImpl->stream);
+    }
+    pImpl->stream.reset();
+
+    // The runtime is shut down with the last camera
+    pImpl->pVRSystem = nullptr;
+    pImpl->pVRTrackedCamera = nullptr;
+    pImpl->session.reset();
+}
+
+uint32_t openvr_camera::TrackedCameraSource::width(const size_t frame) const
+{
+    return pImpl->stream && frame < pImpl->stream->frames.size()
+               ? pImpl->stream->frames[frame].width
+               : 0;
+}
+
+uint32_t openvr_camera::TrackedCameraSource::height(const size_t frame) const
+{
+    return pImpl->stream && frame < pImpl->stream->frames.size()
+               ? pImpl->stream->frames[frame].height
+               : 0;
+}
+
+std::vector<openvr_camera::CameraCalibration>
+openvr_camera::TrackedCameraSource::calibration() const
+{
+    return pImpl->cameras;
+}
+
+bool openvr_camera::TrackedCameraSource::startStreaming()
+{
+    if (!pImpl->stream) {
+        return false;
+    }
+
+    // Only the streaming service is acquired again, the checks of open()
+    // and the frame size are still valid
+    return pImpl->session->startStreaming(*pImpl->stream);
+}
+
+void openvr_camera::TrackedCameraSource::stopStreaming()
+{
+    if (pImpl->stream) {
+        pImpl->session->stopStreaming(*pImpl->stream);
+    }
+}
+
+bool openvr_camera::TrackedCameraSource::streaming() const
+{
+    return pImpl->stream && pImpl->session->streaming(*pImpl->stream);
+}
+
+openvr_camera::GrabResult
+openvr_camera::TrackedCameraSource::grab(std::vector<Frame>& frames,
+                                         FrameHeader& header)
+{
+    if (!pImpl->stream) {
+        yCError(CAMERA) << "grab() called before camera has been opened.";
+        return GrabResult::Error;
+    }
+
+    if (!startStreaming()) {
+        return GrabResult::Error;
+    }
+
+    // The new captures are copied by the polling thread of the session
+    return pImpl->session->take(*pImpl->stream, frames, header);
+}
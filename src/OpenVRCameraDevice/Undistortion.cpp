@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "Undistortion.h"
+#include "OpenVRCameraLogComponent.h"
+
+#include <yarp/os/LogStream.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // Channels of an RGBA pixel spread in the four 16-bit lanes of a 64-bit
+    // word, so that they are weighted with a single multiplication. With
+    // weights summing to 256 no lane can overflow into the next one.
+    inline uint64_t Spread(const uint8_t* pixel)
+    {
+        uint32_t rgba;
+        std::memcpy(&rgba, pixel, sizeof(rgba));
+
+        uint64_t lanes = rgba;
+        lanes = (lanes | (lanes << 16)) & 0x0000FFFF0000FFFFull;
+        lanes = (lanes | (lanes << 8)) & 0x00FF00FF00FF00FFull;
+        return lanes;
+    }
+
+    constexpr uint64_t LaneRounding = 0x0080008000800080ull;
+    constexpr uint64_t LaneMask = 0x00FF00FF00FF00FFull;
+
+    // Normalized coordinates of the distorted ray
+    std::array<double, 2>
+    Distort(const openvr_camera::CameraCalibration& camera,
+            const double x,
+            const double y)
+    {
+        if (camera.model == openvr_camera::DistortionModel::None) {
+            return {x, y};
+        }
+
+        const double r = std::sqrt(x * x + y * y);
+        if (r < 1e-9) {
+            return {x, y};
+        }
+
+        const double theta = std::atan(r);
+        const double theta2 = theta * theta;
+        const auto& k = camera.coefficients;
+        const double polynomial =
+            k[0] + theta2 * (k[1] + theta2 * (k[2] + theta2 * k[3]));
+        const double thetaD = theta * (1.0 + theta2 * polynomial);
+
+        const double scale = thetaD / r;
+        return {x * scale, y * scale};
+    }
+} // namespace
+
+bool openvr_camera::RemapTable::build(
+    const uint32_t inputWidth,
+    const uint32_t inputHeight,
+    const std::vector<CameraCalibration>& cameras,
+    const uint32_t outputWidth,
+    const uint32_t outputHeight)
+{
+    m_indices.clear();
+    m_weights.clear();
+
+    if (cameras.empty() || inputWidth < 2 || inputHeight < 2
+        || outputWidth == 0 || outputHeight == 0) {
+        yCError(CAMERA) << "Invalid undistortion configuration.";
+        return false;
+    }
+
+    m_inputWidth = inputWidth;
+    m_inputHeight = inputHeight;
+    m_outputWidth = outputWidth;
+    m_outputHeight = outputHeight;
+
+    const size_t size = static_cast<size_t>(outputWidth) * outputHeight;
+    m_indices.assign(size, 0);
+    m_weights.assign(size, {0, 0, 0, 0});
+
+    const double scaleX = static_cast<double>(outputWidth) / inputWidth;
+    const double scaleY = static_cast<double>(outputHeight) / inputHeight;
+
+    for (const auto& camera : cameras) {
+        if (camera.fx <= 0.0 || camera.fy <= 0.0 || camera.width < 2
+            || camera.height < 2 || camera.x + camera.width > inputWidth
+            || camera.y + camera.height > inputHeight) {
+            yCError(CAMERA) << "Invalid camera calibration.";
+            return false;
+        }
+
+        // Tile and intrinsics of the camera in the output image
+        const auto u0 = static_cast<uint32_t>(std::lround(camera.x * scaleX));
+        const auto v0 = static_cast<uint32_t>(std::lround(camera.y * scaleY));
+        const auto u1 = std::min<uint32_t>(
+            outputWidth,
+            static_cast<uint32_t>(
+                std::lround((camera.x + camera.width) * scaleX)));
+        const auto v1 = std::min<uint32_t>(
+            outputHeight,
+            static_cast<uint32_t>(
+                std::lround((camera.y + camera.height) * scaleY)));
+
+        const double fx = camera.fx * scaleX;
+        const double fy = camera.fy * scaleY;
+        const double cx = camera.cx * scaleX;
+        const double cy = camera.cy * scaleY;
+
+        for (uint32_t v = v0; v < v1; ++v) {
+            for (uint32_t u = u0; u < u1; ++u) {
+                const auto [xd, yd] =
+                    Distort(camera, (u - u0 + 0.5 - cx) / fx,
+                            (v - v0 + 0.5 - cy) / fy);
+
+                // Position in the tile of the distorted frame, relative
+                // to the centers of the pixels
+                const double px = camera.fx * xd + camera.cx - 0.5;
+                const double py = camera.fy * yd + camera.cy - 0.5;
+
+                if (!(px >= 0.0 && py >= 0.0 && px <= camera.width - 1.0
+                      && py <= camera.height - 1.0)) {
+                    continue;
+                }
+
+                // The bottom-right pixel must stay in the tile
+                const auto x0 = std::min<uint32_t>(
+                    static_cast<uint32_t>(px), camera.width - 2);
+                const auto y0 = std::min<uint32_t>(
+                    static_cast<uint32_t>(py), camera.height - 2);
+                const auto wx = static_cast<uint32_t>(
+                    std::lround((px - x0) * 16.0));
+                const auto wy = static_cast<uint32_t>(
+                    std::lround((py - y0) * 16.0));
+
+                const size_t i = static_cast<size_t>(v) * outputWidth + u;
+                m_indices[i] = (camera.y + y0) * inputWidth + camera.x + x0;
+                m_weights[i] = {static_cast<uint16_t>((16 - wx) * (16 - wy)),
+                                static_cast<uint16_t>(wx * (16 - wy)),
+                                static_cast<uint16_t>((16 - wx) * wy),
+                                static_cast<uint16_t>(wx * wy)};
+            }
+        }
+    }
+
+    return true;
+}
+
+bool openvr_camera::RemapTable::empty() const
+{
+    return m_indices.empty();
+}
+
+uint32_t openvr_camera::RemapTable::width() const
+{
+    return m_outputWidth;
+}
+
+uint32_t openvr_camera::RemapTable::height() const
+{
+    return m_outputHeight;
+}
+
+void openvr_camera::RemapTable::apply(
+    const Frame& frame,
+    yarp::sig::ImageOf<yarp::sig::PixelRgb>& image) const
+{
+    image.resize(m_outputWidth, m_outputHeight);
+
+    if (frame.width != m_inputWidth || frame.height != m_inputHeight
+        || frame.rgba.size()
+               < static_cast<size_t>(m_inputWidth) * m_inputHeight * 4) {
+        yCError(CAMERA) << "The frame does not match the undistortion table.";
+        image.zero();
+        return;
+    }
+
+    const uint8_t* input = frame.rgba.data();
+    const size_t stride = static_cast<size_t>(m_inputWidth) * 4;
+
+    for (uint32_t v = 0; v < m_outputHeight; ++v) {
+        const size_t rowStart = static_cast<size_t>(v) * m_outputWidth;
+        const uint32_t* indices = m_indices.data() + rowStart;
+        const std::array<uint16_t, 4>* weights = m_weights.data() + rowStart;
+        uint8_t* output = image.getRow(v);
+
+        for (uint32_t u = 0; u < m_outputWidth; ++u, output += 3) {
+            const uint8_t* topLeft =
+                input + static_cast<size_t>(indices[u]) * 4;
+            const auto& w = weights[u];
+
+            // All the channels are interpolated at once
+            const uint64_t lanes =
+                ((Spread(topLeft) * w[0] + Spread(topLeft + 4) * w[1]
+                  + Spread(topLeft + stride) * w[2]
+                  + Spread(topLeft + stride + 4) * w[3] + LaneRounding)
+                 >> 8)
+                & LaneMask;
+
+            const bool valid = (lanes >> 48) > 0;
+            output[0] = valid ? static_cast<uint8_t>(lanes) : 0;
+            output[1] = valid ? static_cast<uint8_t>(lanes >> 16) : 0;
+            output[2] = valid ? static_cast<uint8_t>(lanes >> 32) : 0;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef YARP_OPENVR_CAMERA_UNDISTORTION_H
+#define YARP_OPENVR_CAMERA_UNDISTORTION_H
+
+#include "FrameSource.h"
+
+#include <yarp/sig/Image.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace openvr_camera {
+    class RemapTable;
+} // namespace openvr_camera
+
+// Lookup table mapping every pixel of the undistorted image to the four
+// pixels of the distorted frame it is interpolated from. Each camera tile
+// of the frame is mapped to the tile with the same relative position in the
+// output, as seen by a pinhole camera with the same intrinsics scaled to the
+// output resolution.
+class openvr_camera::RemapTable
+{
+public:
+    bool build(const uint32_t inputWidth,
+               const uint32_t inputHeight,
+               const std::vector<CameraCalibration>& cameras,
+               const uint32_t outputWidth,
+               const uint32_t outputHeight);
+
+    bool empty() const;
+    uint32_t width() const;
+    uint32_t height() const;
+
+    // Undistort the RGBA frame and convert it to RGB in a single pass.
+    // Pixels with zero alpha, or outside of the frame, are set to black.
+    void apply(const Frame& frame,
+               yarp::sig::ImageOf<yarp::sig::PixelRgb>& image) const;
+
+private:
+    uint32_t m_inputWidth = 0;
+    uint32_t m_inputHeight = 0;
+    uint32_t m_outputWidth = 0;
+    uint32_t m_outputHeight = 0;
+
+    // Index of the top-left pixel, and bilinear weights of the top-left,
+    // top-right, bottom-left and bottom-right pixels in fixed point summing
+    // to 256, i.e. with a precision of 1/16 of pixel along each axis. Pixels
+    // outside of the frame have all-zero weights.
+    std::vector<uint32_t> m_indices;
+    std::vector<std::array<uint16_t, 4>> m_weights;
+};
+
+#endif // YARP_OPENVR_CAMERA_UNDISTORTION_H
@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+// Throughput benchmark of the OpenVRCamera device.
+//
+// The device is opened with the synthetic frame source, or replays a
+// recording when --replay is given, and is wrapped by a
+// frameGrabber_nws_yarp, whose output is read by a consumer in the same
+// process on a process-local YARP network, so no yarpserver is needed. The
+// benchmark reports the sustained frame rate at the consumer, the CPU time
+// of the process per received frame and the latency between the capture
+// time in the envelope of each image and its reception.
+
+#include "OpenVRCamera.h"
+
+#include <yarp/dev/Drivers.h>
+#include <yarp/dev/PolyDriver.h>
+#include <yarp/dev/WrapperSingle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/ResourceFinder.h>
+#include <yarp/os/Stamp.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Image.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace camera_benchmark {
+    const std::string Prefix = "/cameraBenchmark";
+    constexpr double Warmup = 1.0;
+
+    // User and system time consumed by all the threads of the process
+    double ProcessCpuTime()
+    {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        if (!GetProcessTimes(
+                GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+            return 0.0;
+        }
+        const auto toSeconds = [](const FILETIME& time) {
+            ULARGE_INTEGER ticks;
+            ticks.LowPart = time.dwLowDateTime;
+            ticks.HighPart = time.dwHighDateTime;
+            return static_cast<double>(ticks.QuadPart) * 1e-7;
+        };
+        return toSeconds(kernel) + toSeconds(user);
+#else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+               + 1e-6 * (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+#endif
+    }
+
+    using Image = yarp::sig::ImageOf<yarp::sig::PixelRgb>;
+
+    class Consumer : public yarp::os::TypedReaderCallback<Image>
+    {
+    public:
+        explicit Consumer(yarp::os::BufferedPort<Image>& port)
+            : m_port(port)
+        {
+        }
+
+        void onRead(Image& image) override
+        {
+            const double now = yarp::os::Time::now();
+
+            yarp::os::Stamp stamp;
+            m_port.getEnvelope(stamp);
+
+            const auto lock = std::unique_lock(m_mutex);
+
+            if (!m_recording) {
+                m_lastSequence = stamp.getCount();
+                return;
+            }
+
+            // Sequence numbers skipped by either the source or the wrapper
+            if (m_frames > 0 && stamp.getCount() > m_lastSequence + 1) {
+                m_skipped += stamp.getCount() - m_lastSequence - 1;
+            }
+            m_lastSequence = stamp.getCount();
+
+            m_frames++;
+            m_bytes += image.getRawImageSize();
+            m_latencies.push_back(1e3 * (now - stamp.getTime()));
+        }
+
+        void startRecording()
+        {
+            const auto lock = std::unique_lock(m_mutex);
+            m_recording = true;
+        }
+
+        void stopRecording()
+        {
+            const auto lock = std::unique_lock(m_mutex);
+            m_recording = false;
+        }
+
+        size_t frames() const { return m_frames; }
+        size_t skipped() const { return m_skipped; }
+        size_t bytes() const { return m_bytes; }
+        const std::vector<double>& latencies() const { return m_latencies; }
+
+    private:
+        yarp::os::BufferedPort<Image>& m_port;
+        bool m_recording = false;
+        int m_lastSequence = 0;
+        size_t m_frames = 0;
+        size_t m_skipped = 0;
+        size_t m_bytes = 0;
+        std::vector<double> m_latencies;
+        std::mutex m_mutex;
+    };
+
+    double Percentile(std::vector<double> samples, const double p)
+    {
+        if (samples.empty()) {
+            return 0.0;
+        }
+        const auto nth =
+            samples.begin() + static_cast<long>(p * (samples.size() - 1));
+        std::nth_element(samples.begin(), nth, samples.end());
+        return *nth;
+    }
+} // namespace camera_benchmark
+
+int main(int argc, char** argv)
+{
+    yarp::os::Network yarp;
+
+    // Ports and name server are local to this process
+    yarp::os::Network::setLocalMode(true);
+
+    // The device is compiled in this executable, register it so that the
+    // PolyDriver can find it without loading the plugin
+    yarp::dev::Drivers::factory().add(
+        new yarp::dev::DriverCreatorOf<yarp::dev::OpenVRCamera>(
+            "OpenVRCamera", "", "OpenVRCamera"));
+
+    yarp::os::ResourceFinder rf;
+    rf.configure(argc, argv);
+
+    const int width = rf.check("width", yarp::os::Value(960)).asInt32();
+    const int height = rf.check("height", yarp::os::Value(960)).asInt32();
+    const double fps = rf.check("fps", yarp::os::Value(54.0)).asFloat64();
+    const double dropRate =
+        rf.check("dropRate", yarp::os::Value(0.0)).asFloat64();
+    const double period =
+        rf.check("period", yarp::os::Value(0.5 / fps)).asFloat64();
+    const double duration =
+        rf.check("duration", yarp::os::Value(10.0)).asFloat64();
+    const std::string undistortion =
+        rf.check("undistortion", yarp::os::Value("runtime")).asString();
+    const std::string replay =
+        rf.check("replay", yarp::os::Value("")).asString();
+    const double replaySpeed =
+        rf.check("replaySpeed", yarp::os::Value(1.0)).asFloat64();
+
+    // Open the camera with the synthetic source or the recording
+    yarp::os::Property cameraCfg;
+    cameraCfg.put("device", "OpenVRCamera");
+    cameraCfg.put("undistortion", undistortion);
+    if (replay.empty()) {
+        cameraCfg.put("source", "synthetic");
+        cameraCfg.put("syntheticWidth", width);
+        cameraCfg.put("syntheticHeight", height);
+        cameraCfg.put("syntheticFps", fps);
+        cameraCfg.put("syntheticDropRate", dropRate);
+    }
+    else {
+        cameraCfg.put("source", "replay");
+        cameraCfg.put("replayFile", replay);
+        cameraCfg.put("replaySpeed", replaySpeed);
+    }
+
+    yarp::dev::PolyDriver camera;
+    if (!camera.open(cameraCfg)) {
+        yError() << "Failed to open the OpenVRCamera device";
+        return EXIT_FAILURE;
+    }
+
+    // Wrap it as yarpdev would do
+    yarp::os::Property wrapperCfg;
+    wrapperCfg.put("device", "frameGrabber_nws_yarp");
+    wrapperCfg.put("name", camera_benchmark::Prefix + "/camera");
+    wrapperCfg.put("period", period);
+
+    yarp::dev::PolyDriver wrapper;
+    yarp::dev::WrapperSingle* attachable = nullptr;
+    if (!(wrapper.open(wrapperCfg) && wrapper.view(attachable) && attachable
+          && attachable->attach(&camera))) {
+        yError() << "Failed to attach the frameGrabber_nws_yarp";
+        return EXIT_FAILURE;
+    }
+
+    yarp::os::BufferedPort<camera_benchmark::Image> port;
+    camera_benchmark::Consumer consumer(port);
+    port.useCallback(consumer);
+    if (!port.open(camera_benchmark::Prefix + "/image:i")
+        || !yarp::os::Network::connect(camera_benchmark::Prefix + "/camera",
+                                       port.getName(),
+                                       "fast_tcp")) {
+        yError() << "Failed to connect to the frameGrabber_nws_yarp";
+        return EXIT_FAILURE;
+    }
+
+    yarp::os::Time::delay(camera_benchmark::Warmup);
+
+    const double cpuStart = camera_benchmark::ProcessCpuTime();
+    const double start = yarp::os::Time::now();
+    consumer.startRecording();
+    yarp::os::Time::delay(duration);
+    consumer.stopRecording();
+    const double elapsed = yarp::os::Time::now() - start;
+    const double cpu = camera_benchmark::ProcessCpuTime() - cpuStart;
+
+    port.close();
+    attachable->detach();
+    wrapper.close();
+    camera.close();
+
+    // Report
+    const size_t frames = consumer.frames();
+    const auto& latencies = consumer.latencies();
+    const double max = latencies.empty()
+                           ? 0.0
+                           : *std::max_element(latencies.begin(),
+                                               latencies.end());
+
+    std::cout << std::endl << std::fixed << std::setprecision(3);
+    if (replay.empty()) {
+        std::cout << "resolution:        " << width << "x" << height
+                  << std::endl
+                  << "source rate:       " << fps << " fps (drop rate "
+                  << dropRate << ")" << std::endl;
+    }
+    else {
+        std::cout << "replay:            " << replay << " at speed "
+                  << replaySpeed << std::endl;
+    }
+    std::cout << "wrapper period:    " << period << " s" << std::endl
+              << "undistortion:      " << undistortion << std::endl
+              << "received frames:   " << frames << " (" << consumer.skipped()
+              << " sequence numbers skipped)" << std::endl
+              << "sustained rate:    " << frames / elapsed << " fps, "
+              << 1e-6 * consumer.bytes() / elapsed << " MB/s" << std::endl
+              << "cpu per frame:     "
+              << (frames > 0 ? 1e3 * cpu / frames : 0.0) << " ms ("
+              << 100.0 * cpu / elapsed << "% of a core)" << std::endl
+              << "latency p50/p90/p99/max: "
+              << camera_benchmark::Percentile(latencies, 0.5) << " / "
+              << camera_benchmark::Percentile(latencies, 0.9) << " / "
+              << camera_benchmark::Percentile(latencies, 0.99) << " / "
+              << max << " ms" << std::endl;
+
+    return frames > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
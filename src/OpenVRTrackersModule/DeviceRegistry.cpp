@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "DeviceRegistry.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+namespace {
+    const std::string Header = "# yarp-openvr-trackers device registry v1";
+
+    // Fields separated by tabs, since the properties can contain spaces:
+    // serial type index role model manufacturer
+    constexpr size_t Fields = 6;
+
+    std::vector<std::string> Split(const std::string& line)
+    {
+        // Trailing empty fields are kept, unlike with std::getline
+        std::vector<std::string> fields;
+        size_t begin = 0;
+        for (size_t end; (end = line.find('\t', begin)) != std::string::npos;
+             begin = end + 1) {
+            fields.push_back(line.substr(begin, end - begin));
+        }
+        fields.push_back(line.substr(begin));
+        return fields;
+    }
+
+    // Tabs and newlines would break the format
+    std::string Sanitize(std::string value)
+    {
+        for (auto& c : value) {
+            if (c == '\t' || c == '\n' || c == '\r') {
+                c = ' ';
+            }
+        }
+        return value;
+    }
+
+    std::string UniqueSuffix()
+    {
+        std::random_device device;
+        std::ostringstream suffix;
+        suffix << std::hex << device() << device();
+        return suffix.str();
+    }
+} // namespace
+
+// ====================
+// DeviceRegistry::Impl
+// ====================
+
+class openvr::DeviceRegistry::Impl
+{
+public:
+    std::string path;
+    std::vector<RegisteredDevice> devices;
+
+    mutable std::mutex mutex;
+};
+
+// ==============
+// DeviceRegistry
+// ==============
+
+openvr::DeviceRegistry::DeviceRegistry(const std::string& path)
+    : pImpl{std::make_unique<Impl>()}
+{
+    pImpl->path = path;
+}
+
+openvr::DeviceRegistry::~DeviceRegistry() = default;
+
+const std::string& openvr::DeviceRegistry::path() const
+{
+    return pImpl->path;
+}
+
+bool openvr::DeviceRegistry::load()
+{
+    std::ifstream file(pImpl->path);
+    std::string line;
+    if (!(file && std::getline(file, line) && line == Header)) {
+        return false;
+    }
+
+    std::vector<RegisteredDevice> devices;
+    while (std::getline(file, line)) {
+        if (line.empty()) {
+            continue;
+        }
+
+        const auto fields = Split(line);
+        if (fields.size() != Fields || fields[0].empty()) {
+            return false;
+        }
+
+        RegisteredDevice device;
+        try {
+            device.serialNumber = fields[0];
+            device.type = TrackedDeviceType(std::stoi(fields[1]));
+            device.index = std::stoul(fields[2]);
+            device.role = ControllerRole(std::stoi(fields[3]));
+            device.modelNumber = fields[4];
+            device.manufacturer = fields[5];
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+        devices.push_back(std::move(device));
+    }
+
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->devices = std::move(devices);
+    return true;
+}
+
+bool openvr::DeviceRegistry::save() const
+{
+    std::ostringstream content;
+    content << Header << '\n';
+    {
+        const auto lock = std::unique_lock(pImpl->mutex);
+        for (const auto& device : pImpl->devices) {
+            content << Sanitize(device.serialNumber) << '\t'
+                    << static_cast<int>(device.type) << '\t' << device.index
+                    << '\t' << static_cast<int>(device.role) << '\t'
+                    << Sanitize(device.modelNumber) << '\t'
+                    << Sanitize(device.manufacturer) << '\n';
+        }
+    }
+
+    // Write a temporary file and rename it, so that a crash never leaves a
+    // truncated registry. The name of the temporary file is unique, since
+    // several processes can share the registry: the last one saving wins.
+    const std::string temporary = pImpl->path + ".tmp." + UniqueSuffix();
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        file << content.str();
+        if (!file.flush()) {
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, pImpl->path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+std::vector<openvr::RegisteredDevice> openvr::DeviceRegistry::devices() const
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    return pImpl->devices;
+}
+
+bool openvr::DeviceRegistry::update(const RegisteredDevice& device)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    auto& devices = pImpl->devices;
+
+    for (const auto& registered : devices) {
+        if (registered.serialNumber == device.serialNumber
+            && registered.type == device.type
+            && registered.index == device.index
+            && registered.role == device.role
+            && registered.modelNumber == device.modelNumber
+            && registered.manufacturer == device.manufacturer) {
+            return false;
+        }
+    }
+
+    // The devices previously seen with the same index are superseded, and
+    // the most recent device is moved to the end
+    devices.erase(std::remove_if(devices.begin(),
+                                 devices.end(),
+                                 [&](const RegisteredDevice& registered) {
+                                     return registered.serialNumber
+                                                == device.serialNumber
+                                            || registered.index
+                                                   == device.index;
+                                 }),
+                  devices.end());
+    devices.push_back(device);
+    return true;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef OPENVR_TRACKERS_DEVICE_REGISTRY_H
+#define OPENVR_TRACKERS_DEVICE_REGISTRY_H
+
+#include "OpenVRTrackersDriver.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace openvr {
+    struct RegisteredDevice;
+    class DeviceRegistry;
+} // namespace openvr
+
+// Device seen in a previous session
+struct openvr::RegisteredDevice
+{
+    std::string serialNumber;
+    TrackedDeviceType type = TrackedDeviceType::Invalid;
+    // Index of the device in the runtime when it was last seen
+    size_t index = 0;
+    // Last known properties
+    ControllerRole role = ControllerRole::Invalid;
+    std::string modelNumber;
+    std::string manufacturer;
+};
+
+// Thread-safe cache of the known devices, stored in a text file with a
+// line per device. It lets the DevicesManager start with the devices of
+// the previous session, without waiting for the runtime to enumerate them.
+class openvr::DeviceRegistry
+{
+public:
+    explicit DeviceRegistry(const std::string& path);
+    ~DeviceRegistry();
+
+    const std::string& path() const;
+
+    // Read the file, replacing the devices in memory. It fails if the file
+    // does not exist or cannot be parsed.
+    bool load();
+    // Write the file atomically, replacing it only once fully written. If
+    // several processes save the same file, the last one wins.
+    bool save() const;
+
+    // Ordered from the least to the most recently updated
+    std::vector<RegisteredDevice> devices() const;
+    // Add or replace the device with the same serial number, dropping the
+    // devices registered with the same index. It returns false if the
+    // device was already registered with the same properties.
+    bool update(const RegisteredDevice& device);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+#endif // OPENVR_TRACKERS_DEVICE_REGISTRY_H
@@ -9,15 +9,225 @@
  */
 
 #include "OpenVRTrackersDriver.h"
+#include "DeviceRegistry.h"
+#include "OpenVRTrackersRuntime.h"
 
 #include <openvr.h>
 #include <yarp/os/LogStream.h>
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <iostream>
 #include <mutex>
+#include <shared_mutex>
 #include <thread>
 #include <unordered_map>
+#include <utility>
+
+// =====================
+// Coordinate conventions
+// =====================
+
+namespace {
+    // Rotation from the OpenVR tracking space to the output convention.
+    // All the supported conventions differ only by a signed permutation of
+    // the axes, therefore the conversion is encoded with integer matrices.
+    using AxesMatrix = std::array<std::array<int, 3>, 3>;
+
+    template <openvr::CoordinateConvention>
+    constexpr AxesMatrix Axes = {};
+
+    template <>
+    constexpr AxesMatrix Axes<openvr::CoordinateConvention::OpenVR> = {{
+        {1, 0, 0},
+        {0, 1, 0},
+        {0, 0, 1},
+    }};
+
+    template <>
+    constexpr AxesMatrix Axes<openvr::CoordinateConvention::ROS> = {{
+        {0, 0, -1},
+        {-1, 0, 0},
+        {0, 1, 0},
+    }};
+
+    template <>
+    constexpr AxesMatrix Axes<openvr::CoordinateConvention::Robot> = {{
+        {0, 0, 1},
+        {1, 0, 0},
+        {0, 1, 0},
+    }};
+
+    // Row i of the converted pose is row[i] of the OpenVR pose times sign[i]
+    struct AxesSwizzle
+    {
+        std::array<size_t, 3> row;
+        std::array<double, 3> sign;
+    };
+
+    constexpr bool IsProperSignedPermutation(const AxesMatrix& m)
+    {
+        for (size_t i = 0; i < 3; ++i) {
+            int nonZeroInRow = 0;
+            int nonZeroInCol = 0;
+            for (size_t j = 0; j < 3; ++j) {
+                nonZeroInRow += m[i][j] != 0;
+                nonZeroInCol += m[j][i] != 0;
+                if (m[i][j] < -1 || m[i][j] > 1) {
+                    return false;
+                }
+            }
+            if (nonZeroInRow != 1 || nonZeroInCol != 1) {
+                return false;
+            }
+        }
+
+        const int det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+                        - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+                        + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+        return det == 1;
+    }
+
+    constexpr AxesSwizzle ToSwizzle(const AxesMatrix& m)
+    {
+        AxesSwizzle swizzle{};
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                if (m[i][j] != 0) {
+                    swizzle.row[i] = j;
+                    swizzle.sign[i] = m[i][j];
+                }
+            }
+        }
+        return swizzle;
+    }
+
+    static_assert(IsProperSignedPermutation(
+        Axes<openvr::CoordinateConvention::OpenVR>));
+    static_assert(
+        IsProperSignedPermutation(Axes<openvr::CoordinateConvention::ROS>));
+    static_assert(
+        IsProperSignedPermutation(Axes<openvr::CoordinateConvention::Robot>));
+
+    // Extract the pose from the runtime matrix expressing it in the
+    // tracking space rotated to the given convention (T' = C * T).
+    // Since C is known at compile time, this reduces to a row swizzle.
+    template <openvr::CoordinateConvention Convention>
+    openvr::Pose ExtractPose(const vr::HmdMatrix34_t& m)
+    {
+        constexpr AxesSwizzle swizzle = ToSwizzle(Axes<Convention>);
+
+        openvr::Pose out{};
+        for (size_t i = 0; i < 3; ++i) {
+            const auto& row = m.m[swizzle.row[i]];
+            out.position[i] = swizzle.sign[i] * row[3];
+            out.rotationRowMajor[3 * i + 0] = swizzle.sign[i] * row[0];
+            out.rotationRowMajor[3 * i + 1] = swizzle.sign[i] * row[1];
+            out.rotationRowMajor[3 * i + 2] = swizzle.sign[i] * row[2];
+        }
+        return out;
+    }
+
+    // Express a vector of the tracking space in the given convention
+    template <openvr::CoordinateConvention Convention>
+    std::array<double, 3> ConvertVector(const vr::HmdVector3_t& v)
+    {
+        constexpr AxesSwizzle swizzle = ToSwizzle(Axes<Convention>);
+
+        std::array<double, 3> out;
+        for (size_t i = 0; i < 3; ++i) {
+            out[i] = swizzle.sign[i] * v.v[swizzle.row[i]];
+        }
+        return out;
+    }
+
+    template <openvr::CoordinateConvention Convention>
+    openvr::PlayArea ConvertPlayArea(const vr::HmdQuad_t& rect)
+    {
+        openvr::PlayArea area;
+        for (size_t i = 0; i < area.corners.size(); ++i) {
+            area.corners[i] = ConvertVector<Convention>(rect.vCorners[i]);
+        }
+        area.up = ConvertVector<Convention>({{0.0f, 1.0f, 0.0f}});
+        return area;
+    }
+} // namespace
+
+// ===============
+// Pose processing
+// ===============
+
+namespace {
+    using Rotation = std::array<double, 9>;
+    using Quaternion = std::array<double, 4>;
+
+    // Project an almost orthonormal matrix onto SO(3) with Newton-Schulz
+    // iterations of the polar decomposition: R <- R (3I - R^T R) / 2.
+    // Starting from the float precision of the runtime, two iterations
+    // are enough to reach double precision.
+    void Orthonormalize(Rotation& r)
+    {
+        constexpr size_t Iterations = 2;
+
+        for (size_t it = 0; it < Iterations; ++it) {
+            // S = (3I - R^T R) / 2, which is symmetric
+            Rotation s;
+            for (size_t i = 0; i < 3; ++i) {
+                for (size_t j = i; j < 3; ++j) {
+                    const double dot = r[i] * r[j] + r[3 + i] * r[3 + j]
+                                       + r[6 + i] * r[6 + j];
+                    s[3 * i + j] = (i == j ? 1.5 : 0.0) - 0.5 * dot;
+                    s[3 * j + i] = s[3 * i + j];
+                }
+            }
+
+            // R <- R S
+            const Rotation prev = r;
+            for (size_t i = 0; i < 3; ++i) {
+                for (size_t j = 0; j < 3; ++j) {
+                    r[3 * i + j] = prev[3 * i + 0] * s[0 + j]
+                                   + prev[3 * i + 1] * s[3 + j]
+                                   + prev[3 * i + 2] * s[6 + j];
+                }
+            }
+        }
+    }
+
+    // Shepperd's method, choosing the branch with the largest pivot
+    Quaternion ToQuaternion(const Rotation& r)
+    {
+        Quaternion q;
+        const double trace = r[0] + r[4] + r[8];
+
+        if (trace > 0.0) {
+            const double s = 2.0 * std::sqrt(1.0 + trace);
+            q = {0.25 * s, (r[7] - r[5]) / s, (r[2] - r[6]) / s, (r[3] - r[1]) / s};
+        }
+        else if (r[0] > r[4] && r[0] > r[8]) {
+            const double s = 2.0 * std::sqrt(1.0 + r[0] - r[4] - r[8]);
+            q = {(r[7] - r[5]) / s, 0.25 * s, (r[1] + r[3]) / s, (r[2] + r[6]) / s};
+        }
+        else if (r[4] > r[8]) {
+            const double s = 2.0 * std::sqrt(1.0 + r[4] - r[0] - r[8]);
+            q = {(r[2] - r[6]) / s, (r[1] + r[3]) / s, 0.25 * s, (r[5] + r[7]) / s};
+        }
+        else {
+            const double s = 2.0 * std::sqrt(1.0 + r[8] - r[0] - r[4]);
+            q = {(r[3] - r[1]) / s, (r[2] + r[6]) / s, (r[5] + r[7]) / s, 0.25 * s};
+        }
+
+        const double norm =
+            std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        for (auto& element : q) {
+            element /= norm;
+        }
+
+        return q;
+    }
+} // namespace
 
 // ====================
 // DevicesManager::Impl
@@ -29,14 +239,55 @@ public:
     using TrackedDeviceSerialNumber = std::string;
     std::unordered_map<TrackedDeviceSerialNumber, TrackedDevice> devices;
 
-    vr::IVRSystem* vr = nullptr;
+    std::unique_ptr<Runtime> runtime;
     TrackingUniverseOrigin origin;
+    CoordinateConvention convention = CoordinateConvention::OpenVR;
+    double predictionTime = 0.0;
 
     std::thread detector;
+    std::chrono::duration<double> eventsPeriod = std::chrono::seconds(1);
+    bool stopDetector = false;
+    std::condition_variable_any detectorWakeUp;
 
     mutable std::recursive_mutex mutex;
 
-    std::vector<vr::TrackedDevicePose_t> poses;
+    // Indices of the managed devices for the haptic feedback, with their
+    // own lock so that the pulses do not wait for the poses. The lock is
+    // only held to look up the index, never during the calls to the runtime.
+    std::unordered_map<TrackedDeviceSerialNumber, size_t> hapticDevices;
+    mutable std::mutex hapticsMutex;
+
+    // The haptic calls to the runtime hold a shared lock, so that the
+    // runtime is not shut down while they are in progress
+    bool runtimeAlive = false;
+    mutable std::shared_mutex runtimeMutex;
+
+    PoseProcessingOptions processing;
+
+    // Devices of the previous sessions. The ones inserted at startup are
+    // unverified until the detector thread checks them.
+    std::shared_ptr<DeviceRegistry> registry;
+    bool preloaded = false;
+    // Set by the events, the registry is then updated by the detector
+    // thread without holding the lock of the poses
+    bool registryOutdated = false;
+
+    // Buffers indexed by the device index. The processed poses of the
+    // managed devices are updated in batch by computePoses().
+    std::vector<vr::TrackedDevicePose_t> poses =
+        std::vector<vr::TrackedDevicePose_t>(vr::k_unMaxTrackedDeviceCount);
+    std::vector<Pose> processedPoses =
+        std::vector<Pose>(vr::k_unMaxTrackedDeviceCount);
+    std::vector<std::optional<std::array<double, 4>>> previousQuaternions =
+        std::vector<std::optional<std::array<double, 4>>>(
+            vr::k_unMaxTrackedDeviceCount);
+
+    // Skeletons of the hands, indexed by the index of the device providing
+    // them and updated in the same batch as the poses
+    bool skeletalInput = false;
+    std::vector<std::optional<SkeletalSummary>> skeletalSummaries =
+        std::vector<std::optional<SkeletalSummary>>(
+            vr::k_unMaxTrackedDeviceCount);
 
     static bool DeviceTypeIsSupported(const TrackedDeviceType type)
     {
@@ -50,36 +301,166 @@ public:
         }
     }
 
-    static std::string
-    GetStringProperty(vr::IVRSystem& vr,
-                      const uint32_t index,
-                      const vr::ETrackedDeviceProperty property)
+    void shutdownRuntime()
     {
-        // Allocate the buffer using the maximum allowed size
-        char buffer[vr::k_unMaxPropertyStringSize];
-
-        // Get the string property
-        vr.GetStringTrackedDeviceProperty( //
-            index,
-            property,
-            buffer,
-            vr::k_unMaxPropertyStringSize);
-
-        // Convert to std::string
-        return std::string(buffer);
-    };
+        const auto runtimeLock = std::unique_lock(runtimeMutex);
+        runtimeAlive = false;
+        runtime->shutdown();
+    }
+
+    void insertDevice(const TrackedDevice& device)
+    {
+        devices.insert(std::make_pair(device.serialNumber, device));
+        previousQuaternions[device.index].reset();
+
+        const auto hapticsLock = std::unique_lock(hapticsMutex);
+        hapticDevices[device.serialNumber] = device.index;
+    }
+
+    // Insert the registered devices as they were last seen. If several
+    // devices had the same index, the most recent one is taken.
+    bool preloadRegisteredDevices()
+    {
+        std::vector<bool> used(vr::k_unMaxTrackedDeviceCount, false);
+        const auto registeredDevices = registry->devices();
+
+        for (auto it = registeredDevices.rbegin();
+             it != registeredDevices.rend();
+             ++it) {
+            const RegisteredDevice& registered = *it;
+            if (!(DeviceTypeIsSupported(registered.type)
+                  && registered.index < used.size() && !used[registered.index]
+                  && devices.find(registered.serialNumber) == devices.end())) {
+                continue;
+            }
+            used[registered.index] = true;
+
+            TrackedDevice device;
+            device.index = registered.index;
+            device.serialNumber = registered.serialNumber;
+            device.type = registered.type;
+            insertDevice(device);
+        }
+
+        return !devices.empty();
+    }
+
+    static bool PoseIsUsable(const vr::TrackedDevicePose_t& pose)
+    {
+        return pose.bPoseIsValid
+               && pose.eTrackingResult
+                      == vr::ETrackingResult::TrackingResult_Running_OK;
+    }
+
+    template <CoordinateConvention Convention>
+    void extractPoses()
+    {
+        for (const auto& [_, device] : this->devices) {
+            const auto& pose = poses[device.index];
+            if (PoseIsUsable(pose)) {
+                Pose& out = processedPoses[device.index];
+                out = ExtractPose<Convention>(pose.mDeviceToAbsoluteTracking);
+                out.linearVelocity = ConvertVector<Convention>(pose.vVelocity);
+                out.angularVelocity =
+                    ConvertVector<Convention>(pose.vAngularVelocity);
+            }
+        }
+    }
 
     bool computePoses()
     {
-        poses.resize(this->devices.size());
-        // Get the device pose
-        this->vr->GetDeviceToAbsoluteTrackingPose(
-        vr::ETrackingUniverseOrigin(this->origin),
-        0,
-        &poses[0],
-        this->devices.size());
+        // Get the poses of all the devices. The array is indexed by the
+        // device index, that could be larger than the number of devices.
+        this->runtime->deviceToAbsoluteTrackingPose(
+            vr::ETrackingUniverseOrigin(this->origin),
+            static_cast<float>(this->predictionTime),
+            poses.data(),
+            static_cast<uint32_t>(poses.size()));
+
+        // Convert the poses of the managed devices
+        switch (this->convention) {
+            case CoordinateConvention::ROS:
+                extractPoses<CoordinateConvention::ROS>();
+                break;
+            case CoordinateConvention::Robot:
+                extractPoses<CoordinateConvention::Robot>();
+                break;
+            case CoordinateConvention::OpenVR:
+            default:
+                extractPoses<CoordinateConvention::OpenVR>();
+                break;
+        }
+
+        // Process the rotations of all the devices in one pass
+        for (const auto& [_, device] : this->devices) {
+            if (!PoseIsUsable(poses[device.index])) {
+                continue;
+            }
+
+            Pose& pose = processedPoses[device.index];
+
+            if (processing.orthonormalize) {
+                Orthonormalize(pose.rotationRowMajor);
+            }
+
+            pose.quaternion = ToQuaternion(pose.rotationRowMajor);
+
+            auto& previous = previousQuaternions[device.index];
+            if (processing.quaternionContinuity && previous.has_value()) {
+                const double dot = (*previous)[0] * pose.quaternion[0]
+                                   + (*previous)[1] * pose.quaternion[1]
+                                   + (*previous)[2] * pose.quaternion[2]
+                                   + (*previous)[3] * pose.quaternion[3];
+
+                if (dot < 0.0) {
+                    for (auto& element : pose.quaternion) {
+                        element = -element;
+                    }
+                }
+            }
+
+            previous = pose.quaternion;
+        }
+
+        if (skeletalInput) {
+            readSkeletalSummaries();
+        }
+
         return true;
     }
+
+    void readSkeletalSummaries()
+    {
+        for (auto& summary : skeletalSummaries) {
+            summary.reset();
+        }
+
+        if (!runtime->updateSkeletalInput()) {
+            return;
+        }
+
+        for (const auto hand : {vr::TrackedControllerRole_LeftHand,
+                                vr::TrackedControllerRole_RightHand}) {
+            vr::TrackedDeviceIndex_t index;
+            vr::VRSkeletalSummaryData_t data;
+            vr::EVRSkeletalTrackingLevel level;
+
+            if (!runtime->skeletalSummary(hand, index, data, level)
+                || index >= skeletalSummaries.size()) {
+                continue;
+            }
+
+            SkeletalSummary summary;
+            std::copy(std::begin(data.flFingerCurl),
+                      std::end(data.flFingerCurl),
+                      summary.curl.begin());
+            std::copy(std::begin(data.flFingerSplay),
+                      std::end(data.flFingerSplay),
+                      summary.splay.begin());
+            summary.level = SkeletalTrackingLevel(level);
+            skeletalSummaries[index] = summary;
+        }
+    }
 };
 
 // ==============
@@ -87,29 +468,56 @@ public:
 // ==============
 
 openvr::DevicesManager::DevicesManager()
+    : DevicesManager(std::make_unique<NativeRuntime>())
+{
+}
+
+openvr::DevicesManager::DevicesManager(std::unique_ptr<Runtime> runtime)
     : pImpl{std::make_unique<Impl>()}
 {
+    pImpl->runtime = std::move(runtime);
 }
 
 openvr::DevicesManager::~DevicesManager()
 {
-    if (this->initialized()) {
-        // Tear down the runtime
-        pImpl->vr = nullptr;
-        vr::VR_Shutdown();
+    // Wake up the detector thread and wait for it to terminate. This is
+    // needed also if the runtime has already been shut down by a Quit event.
+    {
+        const auto lock = std::unique_lock(pImpl->mutex);
+        pImpl->stopDetector = true;
+    }
+    pImpl->detectorWakeUp.notify_all();
 
-        // Wait the processor thread to terminate
+    if (pImpl->detector.joinable()) {
         pImpl->detector.join();
     }
+
+    // Tear down the runtime
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->shutdownRuntime();
+}
+
+void openvr::DevicesManager::setEventsPeriod(const double seconds)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->eventsPeriod = std::chrono::duration<double>(seconds);
+}
+
+void openvr::DevicesManager::setDeviceRegistry(
+    std::shared_ptr<DeviceRegistry> registry)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->registry = std::move(registry);
 }
 
 bool openvr::DevicesManager::initialized() const
 {
     const auto lock = std::unique_lock(pImpl->mutex);
-    return pImpl->vr && !std::string(pImpl->vr->GetRuntimeVersion()).empty();
+    return pImpl->runtime->running();
 }
 
-bool openvr::DevicesManager::initialize(const TrackingUniverseOrigin& vrOrigin)
+bool openvr::DevicesManager::initialize(const TrackingUniverseOrigin& vrOrigin,
+                                        const CoordinateConvention& convention)
 {
     if (this->initialized()) {
         yError() << "Already initialized";
@@ -118,56 +526,62 @@ bool openvr::DevicesManager::initialize(const TrackingUniverseOrigin& vrOrigin)
 
     const auto lock = std::unique_lock(pImpl->mutex);
 
-        pImpl->origin = vrOrigin;
+    pImpl->origin = vrOrigin;
+    pImpl->convention = convention;
 
     // =================================
     // Detect and track existing devices
     // =================================
 
     yDebug() << "Initializing OpenVR DeviceManager";
-    vr::EVRInitError eError = vr::VRInitError_None;
-
-    // Start the application in Background:
-    //
-    // The application will not start SteamVR.
-    // If it is not already running the call with VR_Init will fail
-    // with VRInitError_Init_NoServerForBackgroundApp.
-    //
-    // https://github.com/ValveSoftware/openvr/wiki/API-Documentation#initialization-and-cleanup
-    //
-    if (pImpl->vr = vr::VR_Init(&eError, vr::VRApplication_Background);
-        !pImpl->vr) {
-        pImpl->vr = nullptr;
+
+    if (std::string error; !pImpl->runtime->initialize(error)) {
         yError() << "Failed to initialize VR runtime";
-        yError() << vr::VR_GetVRInitErrorAsEnglishDescription(eError);
+        yError() << error;
         return false;
     }
 
     yDebug() << "OpenVR runtime correctly started";
-    yDebug() << "Scanning for existing devices";
+    {
+        const auto runtimeLock = std::unique_lock(pImpl->runtimeMutex);
+        pImpl->runtimeAlive = true;
+    }
 
-    // Get the indices of all the connected devices
-    const auto connectedDevicesIndices = [&]() -> std::vector<size_t> {
-        std::vector<size_t> indices = {};
+    // Devices known from the registry are managed right away, the runtime
+    // is scanned later by the detector thread
+    pImpl->preloaded = pImpl->registry && pImpl->preloadRegisteredDevices();
+
+    if (pImpl->preloaded) {
+        yInfo() << "Using" << pImpl->devices.size()
+                << "devices of the registry" << pImpl->registry->path()
+                << ", verifying them in the background";
+    }
+    else {
+        yDebug() << "Scanning for existing devices";
 
-        for (size_t i = 0; i < vr::k_unMaxTrackedDeviceCount; ++i) {
-            if (pImpl->vr->IsTrackedDeviceConnected(i)) {
-                indices.push_back(i);
+        // Get the indices of all the connected devices
+        const auto connectedDevicesIndices = [&]() -> std::vector<size_t> {
+            std::vector<size_t> indices = {};
+
+            for (size_t i = 0; i < vr::k_unMaxTrackedDeviceCount; ++i) {
+                if (pImpl->runtime->isTrackedDeviceConnected(i)) {
+                    indices.push_back(i);
+                }
             }
-        }
 
-        return indices;
-    }();
+            return indices;
+        }();
 
-    yDebug() << "Found" << connectedDevicesIndices.size() << "devices";
+        yDebug() << "Found" << connectedDevicesIndices.size() << "devices";
 
-    // Add all the devices with supported types
-    for (const auto deviceIndex : connectedDevicesIndices) {
-        yDebug() << "Inserting device with index" << deviceIndex;
+        // Add all the devices with supported types
+        for (const auto deviceIndex : connectedDevicesIndices) {
+            yDebug() << "Inserting device with index" << deviceIndex;
 
-        if (!this->addDevice(deviceIndex)) {
-            yError() << "Failed to add device with index" << deviceIndex;
-            return false;
+            if (!this->addDevice(deviceIndex)) {
+                yError() << "Failed to add device with index" << deviceIndex;
+                return false;
+            }
         }
     }
 
@@ -180,9 +594,24 @@ bool openvr::DevicesManager::initialize(const TrackingUniverseOrigin& vrOrigin)
         yDebug() << "Detector thread: starting";
         this->clearEvents();
 
-        while (this->initialized()) {
+        if (pImpl->registry) {
+            this->verifyRegisteredDevices();
+            this->updateRegistry();
+        }
+
+        auto lock = std::unique_lock(pImpl->mutex);
+
+        while (!pImpl->stopDetector && this->initialized()) {
             this->processEvents();
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+
+            if (std::exchange(pImpl->registryOutdated, false)) {
+                lock.unlock();
+                this->updateRegistry();
+                lock.lock();
+            }
+            pImpl->detectorWakeUp.wait_for(lock, pImpl->eventsPeriod, [this] {
+                return pImpl->stopDetector;
+            });
         }
 
         yDebug() << "Detector thread: exiting";
@@ -195,25 +624,54 @@ bool openvr::DevicesManager::initialize(const TrackingUniverseOrigin& vrOrigin)
     return true;
 }
 
+void openvr::DevicesManager::setTrackingUniverseOrigin(
+    const TrackingUniverseOrigin& vrOrigin)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->origin = vrOrigin;
+
+    // Quaternions in the new origin are not related to the previous ones
+    for (auto& quaternion : pImpl->previousQuaternions) {
+        quaternion.reset();
+    }
+}
+
+void openvr::DevicesManager::setCoordinateConvention(
+    const CoordinateConvention& convention)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->convention = convention;
+
+    for (auto& quaternion : pImpl->previousQuaternions) {
+        quaternion.reset();
+    }
+}
+
+void openvr::DevicesManager::setPredictionTime(const double seconds)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->predictionTime = seconds;
+}
+
 bool openvr::DevicesManager::addDevice(const size_t index)
 {
     const auto lock = std::unique_lock(pImpl->mutex);
 
     // Make sure the device is connected
     yDebug() << "Checking if device is connected";
-    if (!pImpl->vr->IsTrackedDeviceConnected(index)) {
+    if (!pImpl->runtime->isTrackedDeviceConnected(index)) {
         yError() << "Failed to add unconnected device with index" << index;
         return false;
     }
 
     // Get the serial number of the device, used as key in the map where
     // devices are stored
-    std::string serialNumber = Impl::GetStringProperty(
-        *pImpl->vr, index, vr::Prop_SerialNumber_String);
+    std::string serialNumber =
+        pImpl->runtime->stringProperty(index, vr::Prop_SerialNumber_String);
 
     // Get the type of the device
     const TrackedDeviceType type =
-        TrackedDeviceType(pImpl->vr->GetTrackedDeviceClass(index));
+        TrackedDeviceType(pImpl->runtime->trackedDeviceClass(index));
 
     if (!Impl::DeviceTypeIsSupported(type)) {
         yInfo() << "The device" << serialNumber << "has unsupported type";
@@ -239,7 +697,7 @@ bool openvr::DevicesManager::addDevice(const size_t index)
     }
 
     // Insert the new device
-    pImpl->devices.insert(std::make_pair(device.serialNumber, device));
+    pImpl->insertDevice(device);
     yInfo() << "Device " << device.serialNumber << "inserted (index=" << index
             << ")";
     return true;
@@ -255,12 +713,19 @@ bool openvr::DevicesManager::removeDevice(const std::string& serialNumber)
         return false;
     }
 
+    {
+        const auto hapticsLock = std::unique_lock(pImpl->hapticsMutex);
+        pImpl->hapticDevices.erase(serialNumber);
+    }
+
     yDebug() << "Removing device with serial" << serialNumber;
     return true;
 }
 
 std::vector<std::string> openvr::DevicesManager::managedDevices() const
 {
+    const auto lock = std::unique_lock(pImpl->mutex);
+
     std::vector<std::string> managedDevicesSerials;
     managedDevicesSerials.reserve(pImpl->devices.size());
 
@@ -293,8 +758,28 @@ openvr::DevicesManager::type(const std::string& serialNumber) const
     return pImpl->devices[serialNumber].type;
 }
 
+void openvr::DevicesManager::setPoseProcessing(
+    const PoseProcessingOptions& options)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->processing = options;
+}
+
+openvr::PoseProcessingOptions openvr::DevicesManager::poseProcessing() const
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    return pImpl->processing;
+}
+
 bool openvr::DevicesManager::computePoses()
 {
+    if (!this->initialized()) {
+        yError() << "Failed to read data from the runtime, the manager is "
+                 << "not initialized";
+        return false;
+    }
+
+    const auto lock = std::unique_lock(pImpl->mutex);
     return pImpl->computePoses();
 }
 
@@ -316,15 +801,15 @@ openvr::DevicesManager::pose(const std::string& serialNumber) const
     }
 
     // Make sure the device is connected
-    if (!pImpl->vr->IsTrackedDeviceConnected(
+    if (!pImpl->runtime->isTrackedDeviceConnected(
             pImpl->devices[serialNumber].index)) {
         yError();
         return std::nullopt;
     }
 
-    vr::TrackedDevicePose_t pose;
+    const size_t index = pImpl->devices[serialNumber].index;
+    const vr::TrackedDevicePose_t& pose = pImpl->poses[index];
 
-    pose = pImpl->poses[pImpl->devices[serialNumber].index];
     // Check whether the whole received state is valid
     if (pose.eTrackingResult
         != vr::ETrackingResult::TrackingResult_Running_OK) {
@@ -339,27 +824,33 @@ openvr::DevicesManager::pose(const std::string& serialNumber) const
         return std::nullopt;
     }
 
-    // Build and return the pose
-    return [&pose]() -> const Pose {
-        Pose out;
-        out.position = {
-            pose.mDeviceToAbsoluteTracking.m[0][3],
-            pose.mDeviceToAbsoluteTracking.m[1][3],
-            pose.mDeviceToAbsoluteTracking.m[2][3],
-        };
-        out.rotationRowMajor = {
-            pose.mDeviceToAbsoluteTracking.m[0][0],
-            pose.mDeviceToAbsoluteTracking.m[0][1],
-            pose.mDeviceToAbsoluteTracking.m[0][2],
-            pose.mDeviceToAbsoluteTracking.m[1][0],
-            pose.mDeviceToAbsoluteTracking.m[1][1],
-            pose.mDeviceToAbsoluteTracking.m[1][2],
-            pose.mDeviceToAbsoluteTracking.m[2][0],
-            pose.mDeviceToAbsoluteTracking.m[2][1],
-            pose.mDeviceToAbsoluteTracking.m[2][2],
-        };
-        return out;
-    }();
+    // Return the pose converted and processed by computePoses()
+    return pImpl->processedPoses[index];
+}
+
+std::optional<openvr::DeviceState>
+openvr::DevicesManager::state(const std::string& serialNumber) const
+{
+    if (!this->initialized()) {
+        return std::nullopt;
+    }
+
+    const auto lock = std::unique_lock(pImpl->mutex);
+
+    const auto it = pImpl->devices.find(serialNumber);
+    if (it == pImpl->devices.end()) {
+        return std::nullopt;
+    }
+
+    const size_t index = it->second.index;
+    const vr::TrackedDevicePose_t& pose = pImpl->poses[index];
+
+    DeviceState state;
+    state.connected = pose.bDeviceIsConnected;
+    state.poseIsValid = pose.bPoseIsValid;
+    state.trackingResult = TrackingResult(pose.eTrackingResult);
+
+    return state;
 }
 
 bool openvr::DevicesManager::resetSeatedPosition()
@@ -372,11 +863,137 @@ bool openvr::DevicesManager::resetSeatedPosition()
 
     const auto lock = std::unique_lock(pImpl->mutex);
 
-    vr::VRChaperone()->ResetZeroPose(vr::ETrackingUniverseOrigin::TrackingUniverseSeated);
+    pImpl->runtime->resetZeroPose(
+        vr::ETrackingUniverseOrigin::TrackingUniverseSeated);
+
+    return true;
+}
+
+std::optional<openvr::PlayArea> openvr::DevicesManager::playArea() const
+{
+    if (!this->initialized()) {
+        yError() << "Failed to read data from the runtime, the manager is "
+                 << "not initialized";
+        return std::nullopt;
+    }
+
+    const auto lock = std::unique_lock(pImpl->mutex);
+
+    if (pImpl->origin != TrackingUniverseOrigin::Standing) {
+        yError() << "The play area is available only with the Standing"
+                 << "origin";
+        return std::nullopt;
+    }
+
+    vr::HmdQuad_t rect;
+    if (!pImpl->runtime->playAreaRect(rect)) {
+        yError() << "The play area is not set up in the chaperone";
+        return std::nullopt;
+    }
+
+    switch (pImpl->convention) {
+        case CoordinateConvention::ROS:
+            return ConvertPlayArea<CoordinateConvention::ROS>(rect);
+        case CoordinateConvention::Robot:
+            return ConvertPlayArea<CoordinateConvention::Robot>(rect);
+        case CoordinateConvention::OpenVR:
+        default:
+            return ConvertPlayArea<CoordinateConvention::OpenVR>(rect);
+    }
+}
+
+bool openvr::DevicesManager::triggerHapticPulse(
+    const std::string& serialNumber,
+    const uint32_t axis,
+    const std::chrono::microseconds duration)
+{
+    constexpr std::chrono::microseconds::rep MaxDuration = 3999;
+    const auto durationUs = static_cast<unsigned short>(
+        std::clamp(duration.count(),
+                   std::chrono::microseconds::rep(0),
+                   MaxDuration));
+
+    size_t index = 0;
+    {
+        const auto lock = std::unique_lock(pImpl->hapticsMutex);
+
+        const auto it = pImpl->hapticDevices.find(serialNumber);
+        if (it == pImpl->hapticDevices.end()) {
+            return false;
+        }
+        index = it->second;
+    }
+
+    const auto runtimeLock = std::shared_lock(pImpl->runtimeMutex);
+    if (!pImpl->runtimeAlive) {
+        return false;
+    }
+
+    pImpl->runtime->triggerHapticPulse(
+        static_cast<vr::TrackedDeviceIndex_t>(index), axis, durationUs);
+    return true;
+}
+
+std::optional<std::string>
+openvr::DevicesManager::deviceWithRole(const ControllerRole role) const
+{
+    std::unordered_map<std::string, size_t> devices;
+    {
+        const auto lock = std::unique_lock(pImpl->hapticsMutex);
+        devices = pImpl->hapticDevices;
+    }
+
+    const auto runtimeLock = std::shared_lock(pImpl->runtimeMutex);
+    if (!pImpl->runtimeAlive) {
+        return std::nullopt;
+    }
+
+    // The role can change at any time, e.g. when the controllers are
+    // swapped, and is not cached
+    for (const auto& [serialNumber, index] : devices) {
+        if (ControllerRole(pImpl->runtime->controllerRole(
+                static_cast<vr::TrackedDeviceIndex_t>(index)))
+            == role) {
+            return serialNumber;
+        }
+    }
+
+    return std::nullopt;
+}
+
+bool openvr::DevicesManager::enableSkeletalInput()
+{
+    if (!this->initialized()) {
+        yError() << "Failed to enable the skeletal input, the manager is "
+                 << "not initialized";
+        return false;
+    }
+
+    const auto lock = std::unique_lock(pImpl->mutex);
+
+    std::string error;
+    if (!pImpl->runtime->enableSkeletalInput(error)) {
+        yError() << "Failed to enable the skeletal input:" << error;
+        return false;
+    }
 
+    pImpl->skeletalInput = true;
     return true;
 }
 
+std::optional<openvr::SkeletalSummary>
+openvr::DevicesManager::skeletalSummary(const std::string& serialNumber) const
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+
+    const auto it = pImpl->devices.find(serialNumber);
+    if (it == pImpl->devices.end()) {
+        return std::nullopt;
+    }
+
+    return pImpl->skeletalSummaries[it->second.index];
+}
+
 // ===============
 // Private methods
 // ===============
@@ -387,7 +1004,7 @@ void openvr::DevicesManager::clearEvents()
     vr::VREvent_t event;
     const auto lock = std::unique_lock(pImpl->mutex);
 
-    while (pImpl->vr->PollNextEvent(&event, sizeof(event))) {
+    while (pImpl->runtime->pollNextEvent(event)) {
         number++;
     }
 
@@ -404,7 +1021,7 @@ void openvr::DevicesManager::processEvents()
         return;
     }
 
-    while (pImpl->vr->PollNextEvent(&event, sizeof(event))) {
+    while (pImpl->runtime->pollNextEvent(event)) {
 
         // yDebug() << "Received event:"
         //          << pImpl->vr->GetEventTypeNameFromEnum(
@@ -413,13 +1030,22 @@ void openvr::DevicesManager::processEvents()
 
         switch (event.eventType) {
             case vr::VREvent_TrackedDeviceActivated: {
-                this->addDevice(event.trackedDeviceIndex);
+                if (this->addDevice(event.trackedDeviceIndex)
+                    && pImpl->registry) {
+                    pImpl->registryOutdated = true;
+                }
                 break;
             }
             case vr::VREvent_TrackedDeviceDeactivated: {
+                // Collect the serials first, removing a device invalidates
+                // the iterators of the map
+                std::vector<std::string> deactivated;
                 for (const auto& [sn, device] : pImpl->devices) {
                     if (device.index == event.trackedDeviceIndex)
-                        this->removeDevice(sn);
+                        deactivated.push_back(sn);
+                }
+                for (const auto& sn : deactivated) {
+                    this->removeDevice(sn);
                 }
                 break;
             }
@@ -430,7 +1056,7 @@ void openvr::DevicesManager::processEvents()
                 break;
             case vr::VREvent_Quit: {
                 // Notify we need to do some work before quitting
-                pImpl->vr->AcknowledgeQuit_Exiting();
+                pImpl->runtime->acknowledgeQuit();
 
                 // Remove all the tracked devices
                 for (const auto& serial : this->managedDevices()) {
@@ -441,8 +1067,7 @@ void openvr::DevicesManager::processEvents()
                 }
 
                 // Shutdown the runtime
-                pImpl->vr = nullptr;
-                vr::VR_Shutdown();
+                pImpl->shutdownRuntime();
                 break;
             }
             default:
@@ -451,8 +1076,109 @@ void openvr::DevicesManager::processEvents()
 
         // Break early when attempting to process events after
         // the Quit event has been received
-        if (!pImpl->vr) {
+        if (!pImpl->runtime->running()) {
             break;
         }
     }
 }
+
+void openvr::DevicesManager::verifyRegisteredDevices()
+{
+    std::vector<TrackedDevice> registered;
+    {
+        const auto lock = std::unique_lock(pImpl->mutex);
+        if (!pImpl->preloaded) {
+            return;
+        }
+        for (const auto& [_, device] : pImpl->devices) {
+            registered.push_back(device);
+        }
+    }
+
+    // Query the runtime without holding the lock, so that the poses of the
+    // registered devices keep being computed meanwhile
+    std::vector<bool> verified(vr::k_unMaxTrackedDeviceCount, false);
+    std::vector<std::string> stale;
+
+    for (const auto& device : registered) {
+        const auto index = static_cast<vr::TrackedDeviceIndex_t>(device.index);
+        if (pImpl->runtime->isTrackedDeviceConnected(index)
+            && pImpl->runtime->stringProperty(
+                   index, vr::Prop_SerialNumber_String)
+                   == device.serialNumber
+            && TrackedDeviceType(pImpl->runtime->trackedDeviceClass(index))
+                   == device.type) {
+            verified[device.index] = true;
+        }
+        else {
+            stale.push_back(device.serialNumber);
+        }
+    }
+
+    std::vector<size_t> unknown;
+    for (size_t i = 0; i < vr::k_unMaxTrackedDeviceCount; ++i) {
+        if (!verified[i] && pImpl->runtime->isTrackedDeviceConnected(i)) {
+            unknown.push_back(i);
+        }
+    }
+
+    // Replace the devices that are not where they were
+    const auto lock = std::unique_lock(pImpl->mutex);
+
+    for (const auto& serialNumber : stale) {
+        yInfo() << "The registered device" << serialNumber
+                << "is not connected at its previous index";
+        this->removeDevice(serialNumber);
+    }
+    for (const auto index : unknown) {
+        this->addDevice(index);
+    }
+
+    pImpl->preloaded = false;
+    yInfo() << "Registered devices verified:"
+            << registered.size() - stale.size() << "confirmed,"
+            << stale.size() << "removed," << unknown.size() << "scanned";
+}
+
+void openvr::DevicesManager::updateRegistry()
+{
+    std::vector<TrackedDevice> managed;
+    {
+        const auto lock = std::unique_lock(pImpl->mutex);
+        for (const auto& [_, device] : pImpl->devices) {
+            managed.push_back(device);
+        }
+    }
+
+    // Refresh the properties of the managed devices. Neither the queries to
+    // the runtime nor the disk hold the lock of the poses.
+    bool changed = false;
+    {
+        const auto runtimeLock = std::shared_lock(pImpl->runtimeMutex);
+        if (!pImpl->runtimeAlive) {
+            return;
+        }
+
+        for (const auto& device : managed) {
+            const auto index =
+                static_cast<vr::TrackedDeviceIndex_t>(device.index);
+
+            RegisteredDevice registered;
+            registered.serialNumber = device.serialNumber;
+            registered.type = device.type;
+            registered.index = device.index;
+            registered.role =
+                ControllerRole(pImpl->runtime->controllerRole(index));
+            registered.modelNumber = pImpl->runtime->stringProperty(
+                index, vr::Prop_ModelNumber_String);
+            registered.manufacturer = pImpl->runtime->stringProperty(
+                index, vr::Prop_ManufacturerName_String);
+            changed = pImpl->registry->update(registered) || changed;
+        }
+    }
+
+    if (changed && !pImpl->registry->save()) {
+        yWarning() << "Failed to save the device registry"
+                   << pImpl->registry->path();
+    }
+}
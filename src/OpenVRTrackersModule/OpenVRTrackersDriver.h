@@ -12,6 +12,8 @@
 #define OPENVR_TRACKERS_DRIVER_H
 
 #include <array>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -19,8 +21,14 @@
 
 namespace openvr {
     struct Pose;
+    struct DeviceState;
+    struct PlayArea;
+    struct SkeletalSummary;
+    struct PoseProcessingOptions;
     struct TrackedDevice;
     class DevicesManager;
+    class DeviceRegistry;
+    class Runtime;
 
     enum class TrackingUniverseOrigin
     {
@@ -29,6 +37,15 @@ namespace openvr {
         Raw = 2,
     };
 
+    // Axes convention of the published poses. OpenVR uses a right-handed
+    // Y-up frame with -Z forward, the other conventions are Z-up.
+    enum class CoordinateConvention
+    {
+        OpenVR = 0, // x right, y up, z backward
+        ROS = 1, // REP-103: x forward, y left, z up
+        Robot = 2, // iCub root frame: x backward, y right, z up
+    };
+
     enum class TrackedDeviceType
     {
         Invalid = 0,
@@ -38,12 +55,85 @@ namespace openvr {
         TrackingReference = 4,
         DisplayRedirect = 5,
     };
+
+    // Values of vr::ETrackingResult
+    enum class TrackingResult
+    {
+        Uninitialized = 1,
+        CalibratingInProgress = 100,
+        CalibratingOutOfRange = 101,
+        RunningOK = 200,
+        RunningOutOfRange = 201,
+        FallbackRotationOnly = 300,
+    };
+
+    // Values of vr::ETrackedControllerRole
+    enum class ControllerRole
+    {
+        Invalid = 0,
+        LeftHand = 1,
+        RightHand = 2,
+        OptOut = 3,
+        Treadmill = 4,
+        Stylus = 5,
+    };
+
+    // Values of vr::EVRSkeletalTrackingLevel
+    enum class SkeletalTrackingLevel
+    {
+        Estimated = 0,
+        Partial = 1,
+        Full = 2,
+    };
 } // namespace openvr
 
 struct openvr::Pose
 {
     std::array<double, 3> position;
     std::array<double, 9> rotationRowMajor;
+    std::array<double, 4> quaternion; // w, x, y, z
+    // Velocities reported by the runtime, expressed in the tracking space
+    // like the position (m/s, rad/s)
+    std::array<double, 3> linearVelocity = {};
+    std::array<double, 3> angularVelocity = {};
+};
+
+// Tracking state of a device in the last batch read by computePoses()
+struct openvr::DeviceState
+{
+    bool connected = false;
+    bool poseIsValid = false;
+    TrackingResult trackingResult = TrackingResult::Uninitialized;
+};
+
+// Rectangle of the play area set up in the chaperone
+struct openvr::PlayArea
+{
+    // Corners on the floor, in the output convention
+    std::array<std::array<double, 3>, 4> corners;
+    // Unit vector pointing up, in the output convention
+    std::array<double, 3> up;
+};
+
+// Summary of the skeleton of a hand, as measured by its controller
+struct openvr::SkeletalSummary
+{
+    // Thumb, index, middle, ring and pinky, from 0 (extended) to 1 (curled)
+    std::array<double, 5> curl;
+    // Gaps between adjacent fingers, from 0 (together) to 1 (spread)
+    std::array<double, 4> splay;
+    SkeletalTrackingLevel level = SkeletalTrackingLevel::Estimated;
+};
+
+// Optional processing applied to the poses of all the devices when they
+// are computed
+struct openvr::PoseProcessingOptions
+{
+    // Project the rotation matrices onto SO(3)
+    bool orthonormalize = false;
+    // Keep the quaternion of each device in the hemisphere of its previous
+    // sample, avoiding sign flips between consecutive frames
+    bool quaternionContinuity = false;
 };
 
 struct openvr::TrackedDevice
@@ -57,27 +147,75 @@ class openvr::DevicesManager
 {
 public:
     DevicesManager();
+    explicit DevicesManager(std::unique_ptr<Runtime> runtime);
     ~DevicesManager();
 
-    bool initialize(const TrackingUniverseOrigin& vrOrigin = TrackingUniverseOrigin::Seated);
+    // Period of the thread processing the runtime events, to be set
+    // before the initialization
+    void setEventsPeriod(const double seconds);
+
+    // Registry of the devices of the previous sessions, to be set before
+    // the initialization. The registered devices are managed as soon as the
+    // manager is initialized, without querying the runtime. The thread
+    // processing the events then verifies them in the background, replacing
+    // the devices found at a different index, and keeps the registry
+    // updated.
+    void setDeviceRegistry(std::shared_ptr<DeviceRegistry> registry);
+
+    bool initialize(
+        const TrackingUniverseOrigin& vrOrigin = TrackingUniverseOrigin::Seated,
+        const CoordinateConvention& convention = CoordinateConvention::OpenVR);
     bool initialized() const;
 
+    void setTrackingUniverseOrigin(const TrackingUniverseOrigin& vrOrigin);
+    void setCoordinateConvention(const CoordinateConvention& convention);
+    void setPredictionTime(const double seconds);
+
     bool addDevice(const size_t index);
     bool removeDevice(const std::string& serialNumber);
     std::vector<std::string> managedDevices() const;
 
     TrackedDeviceType type(const std::string& serialNumber) const;
+
+    void setPoseProcessing(const PoseProcessingOptions& options);
+    PoseProcessingOptions poseProcessing() const;
+
     bool computePoses();
     std::optional<Pose> pose(const std::string& serialNumber) const;
 
+    // Unlike pose(), it does not log when the pose is not usable and can be
+    // polled at the rate of computePoses()
+    std::optional<DeviceState> state(const std::string& serialNumber) const;
+
     bool resetSeatedPosition();
 
+    // The play area is defined in the standing universe, it is not
+    // available with the other origins
+    std::optional<PlayArea> playArea() const;
+
+    // Haptic feedback. Unlike the other methods, these do not wait for
+    // computePoses() and can be called with low latency from another
+    // thread. The duration of a pulse is limited to 3999 us by the runtime,
+    // which also ignores the pulses sent to an axis less than 5 ms apart.
+    bool triggerHapticPulse(const std::string& serialNumber,
+                            const uint32_t axis,
+                            const std::chrono::microseconds duration);
+    std::optional<std::string> deviceWithRole(const ControllerRole role) const;
+
+    // Skeletal input of the hands, read by computePoses() together with the
+    // poses once enabled
+    bool enableSkeletalInput();
+    std::optional<SkeletalSummary>
+    skeletalSummary(const std::string& serialNumber) const;
+
 private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
 
     void clearEvents();
     void processEvents();
+    void verifyRegisteredDevices();
+    void updateRegistry();
 };
 
 #endif // OPENVR_TRACKERS_DRIVER_H
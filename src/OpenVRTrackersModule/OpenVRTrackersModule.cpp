@@ -9,7 +9,16 @@
  */
 
 #include "OpenVRTrackersModule.h"
+#include "AsyncLog.h"
+#include "ConfigOptions.h"
+#include "DeviceRegistry.h"
+#include "SimulatedRuntime.h"
 #include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Time.h>
+
+#include <algorithm>
+#include <cmath>
 
 namespace openvr_trackers_module {
     constexpr double DefaultPeriod = 0.010;
@@ -19,12 +28,229 @@ namespace openvr_trackers_module {
     const std::string ModuleName = "OpenVRTrackersModule";
     const std::string LogPrefix = ModuleName + ":";
     const std::string DefaultVrOrigin = "Seated";
+    const std::string DefaultOutputConvention = "OpenVR";
+    constexpr double DefaultHistoryDuration = 10.0;
+    constexpr double MaxPredictionTime = 0.1;
+    constexpr int DefaultSimulatedDevices = 3;
+    constexpr double DefaultWorkspaceHysteresis = 0.01;
+    constexpr double DefaultParentTimeout = 0.1;
+    // Periods without heartbeat after which a standby instance takes over
+    constexpr double HeartbeatCycles = 2.5;
+    constexpr double HapticLatencySmoothing = 0.05;
+
+    using Transform = std::array<double, 12>;
+
+    // The name of the published frame is "{prefix}{serial_number}", with a
+    // prefix that depends on the device type
+    std::string FrameName(const openvr::TrackedDeviceType type,
+                          const std::string& serialNumber)
+    {
+        std::string prefix;
+
+        switch (type) {
+            case openvr::TrackedDeviceType::HMD:
+                prefix = "/hmd/";
+                break;
+            case openvr::TrackedDeviceType::Controller:
+                prefix = "/controllers/";
+                break;
+            case openvr::TrackedDeviceType::GenericTracker:
+                prefix = "/trackers/";
+                break;
+            default:
+                break;
+        }
+
+        return prefix + serialNumber;
+    }
+
+    std::string ToLower(std::string value)
+    {
+        std::transform(value.begin(),
+                       value.end(),
+                       value.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        return value;
+    }
+
+    std::optional<openvr::TrackingUniverseOrigin>
+    ParseVrOrigin(const std::string& value)
+    {
+        const std::string origin = ToLower(value);
+
+        if (origin == "seated") {
+            return openvr::TrackingUniverseOrigin::Seated;
+        }
+        if (origin == "standing") {
+            return openvr::TrackingUniverseOrigin::Standing;
+        }
+        if (origin == "raw") {
+            return openvr::TrackingUniverseOrigin::Raw;
+        }
+        return std::nullopt;
+    }
+
+    std::optional<openvr::CoordinateConvention>
+    ParseOutputConvention(const std::string& value)
+    {
+        const std::string convention = ToLower(value);
+
+        if (convention == "openvr") {
+            return openvr::CoordinateConvention::OpenVR;
+        }
+        if (convention == "ros") {
+            return openvr::CoordinateConvention::ROS;
+        }
+        if (convention == "robot") {
+            return openvr::CoordinateConvention::Robot;
+        }
+        return std::nullopt;
+    }
+
+    std::optional<openvr::ControllerRole> ParseRole(const std::string& value)
+    {
+        const std::string role = ToLower(value);
+
+        if (role == "left") {
+            return openvr::ControllerRole::LeftHand;
+        }
+        if (role == "right") {
+            return openvr::ControllerRole::RightHand;
+        }
+        return std::nullopt;
+    }
+
+    std::string TypeName(const openvr::TrackedDeviceType type)
+    {
+        switch (type) {
+            case openvr::TrackedDeviceType::HMD:
+                return "HMD";
+            case openvr::TrackedDeviceType::Controller:
+                return "Controller";
+            case openvr::TrackedDeviceType::GenericTracker:
+                return "GenericTracker";
+            case openvr::TrackedDeviceType::TrackingReference:
+                return "TrackingReference";
+            case openvr::TrackedDeviceType::DisplayRedirect:
+                return "DisplayRedirect";
+            default:
+                return "Invalid";
+        }
+    }
+
+    // Parse a list of N numbers
+    template <size_t N>
+    std::optional<std::array<double, N>>
+    ParseArray(const yarp::os::Value& value)
+    {
+        const yarp::os::Bottle* list = value.asList();
+        if (!(list && list->size() == N)) {
+            return std::nullopt;
+        }
+
+        std::array<double, N> array;
+        for (size_t i = 0; i < N; ++i) {
+            if (!(list->get(i).isFloat64() || list->get(i).isInt32())) {
+                return std::nullopt;
+            }
+            array[i] = list->get(i).asFloat64();
+        }
+        return array;
+    }
+
+    // 3x4 row-major transform of a pose
+    Transform ToTransform(const openvr::Pose& pose)
+    {
+        const auto& r = pose.rotationRowMajor;
+        const auto& p = pose.position;
+
+        return {r[0], r[1], r[2], p[0], //
+                r[3], r[4], r[5], p[1], //
+                r[6], r[7], r[8], p[2]};
+    }
+
+    // 3x4 row-major transform of a position and a (w, x, y, z) quaternion,
+    // that is normalized
+    std::optional<Transform>
+    ToTransform(const std::array<double, 3>& p, std::array<double, 4> q)
+    {
+        const double norm =
+            std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        if (!(norm > 0.0)) {
+            return std::nullopt;
+        }
+        for (auto& element : q) {
+            element /= norm;
+        }
+        const auto [w, x, y, z] = q;
+
+        return Transform{1 - 2 * (y * y + z * z),
+                         2 * (x * y - w * z),
+                         2 * (x * z + w * y),
+                         p[0],
+                         2 * (x * y + w * z),
+                         1 - 2 * (x * x + z * z),
+                         2 * (y * z - w * x),
+                         p[1],
+                         2 * (x * z - w * y),
+                         2 * (y * z + w * x),
+                         1 - 2 * (x * x + y * y),
+                         p[2]};
+    }
+
+    // Replace all the transforms T with parent * T, in a single pass
+    void ComposeAll(const Transform& parent, std::vector<Transform>& transforms)
+    {
+        const auto& a = parent;
+
+        for (auto& b : transforms) {
+            Transform c;
+            for (size_t row = 0; row < 3; ++row) {
+                const double* ar = &a[4 * row];
+                for (size_t col = 0; col < 4; ++col) {
+                    c[4 * row + col] = ar[0] * b[col] + ar[1] * b[4 + col]
+                                       + ar[2] * b[8 + col];
+                }
+                c[4 * row + 3] += ar[3];
+            }
+            b = c;
+        }
+    }
 } // namespace openvr_trackers_module
 
 bool OpenVRTrackersModule::configure(yarp::os::ResourceFinder& rf)
 {
     const auto lock = std::unique_lock(m_mutex);
 
+    // Write the log from a background thread, so that the terminal or the
+    // file never block the cycle
+    if (rf.check("asyncLog", yarp::os::Value(true)).asBool()) {
+        openvr_log::AsyncLogOptions options;
+        if (rf.check("logFile")) {
+            options.file = rf.find("logFile").asString();
+        }
+        if (rf.check("logQueueSize")) {
+            const yarp::os::Value& size = rf.find("logQueueSize");
+            if (!(size.isInt32() && size.asInt32() > 0
+                  && static_cast<size_t>(size.asInt32())
+                         <= openvr_log::AsyncLogOptions::MaxCapacity)) {
+                yError() << openvr_trackers_module::LogPrefix
+                         << "The logQueueSize option must be an integer"
+                         << "between 1 and"
+                         << openvr_log::AsyncLogOptions::MaxCapacity;
+                return false;
+            }
+            options.capacity = static_cast<size_t>(size.asInt32());
+        }
+
+        m_asyncLog = openvr_log::Install(options);
+        if (!m_asyncLog) {
+            yError() << openvr_trackers_module::LogPrefix
+                     << "Failed to open the log file" << options.file;
+            return false;
+        }
+    }
+
     // ===========================
     // Check configuration options
     // ===========================
@@ -44,13 +270,16 @@ bool OpenVRTrackersModule::configure(yarp::os::ResourceFinder& rf)
     this->setName(name.c_str());
 
     // Try to find the "period" entry
-    if (!(rf.check("period") && rf.find("period").isFloat64())) {
+    m_config.period = openvr_trackers_module::DefaultPeriod;
+    if (!rf.check("period")) {
         yInfo() << openvr_trackers_module::LogPrefix << "Using default period:"
                 << openvr_trackers_module::DefaultPeriod << "s";
-        m_period = openvr_trackers_module::DefaultPeriod;
     }
-    else {
-        m_period = rf.find("period").asFloat64();
+    if (!(openvr_common::FindNumber(rf, "period", m_config.period)
+          && m_config.period > 0.0)) {
+        yError() << openvr_trackers_module::LogPrefix
+                 << "The period must be a positive number.";
+        return false;
     }
 
     // Try to find the "tfBaseFrameName" entry
@@ -59,10 +288,10 @@ bool OpenVRTrackersModule::configure(yarp::os::ResourceFinder& rf)
         yInfo() << openvr_trackers_module::LogPrefix
                 << "Using default tfBaseFrameName:"
                 << openvr_trackers_module::DefaultTfBaseFrameName;
-        m_baseFrame = openvr_trackers_module::DefaultTfBaseFrameName;
+        m_config.baseFrame = openvr_trackers_module::DefaultTfBaseFrameName;
     }
     else {
-        m_baseFrame = rf.find("tfBaseFrameName").asString();
+        m_config.baseFrame = rf.find("tfBaseFrameName").asString();
     }
 
     // Try to find the "tfLocal" entry
@@ -89,31 +318,149 @@ bool OpenVRTrackersModule::configure(yarp::os::ResourceFinder& rf)
     }
 
     // Try to find the "vrOrigin" entry
-    std::string vrOriginString;
-    openvr::TrackingUniverseOrigin vrOrigin = openvr::TrackingUniverseOrigin::Seated;
     if (!(rf.check("vrOrigin") && rf.find("vrOrigin").isString())) {
         yInfo() << openvr_trackers_module::LogPrefix
                 << "Using default vrOrigin:"
                 << openvr_trackers_module::DefaultVrOrigin;
-        vrOriginString = openvr_trackers_module::DefaultVrOrigin;
+    }
+    else if (const auto vrOrigin = openvr_trackers_module::ParseVrOrigin(
+                 rf.find("vrOrigin").asString())) {
+        m_config.vrOrigin = vrOrigin.value();
     }
     else {
-        vrOriginString = rf.find("vrOrigin").asString();
-        std::transform(vrOriginString.begin(), vrOriginString.end(), vrOriginString.begin(), [](unsigned char c){ return std::tolower(c); });
-        if(vrOriginString == "seated") {
-            vrOrigin = openvr::TrackingUniverseOrigin::Seated;
-        }
-        else if(vrOriginString == "standing") {
-            vrOrigin = openvr::TrackingUniverseOrigin::Standing;
-        }
-        else if(vrOriginString == "raw") {
-            vrOrigin = openvr::TrackingUniverseOrigin::Raw;
+        yWarning() << openvr_trackers_module::LogPrefix
+                   << "Invalid inserted vrOrigin value: "
+                   << rf.find("vrOrigin").asString()
+                   << ", using the default value: seated";
+    }
+
+    // Try to find the "outputConvention" entry
+    if (!(rf.check("outputConvention")
+          && rf.find("outputConvention").isString())) {
+        yInfo() << openvr_trackers_module::LogPrefix
+                << "Using default outputConvention:"
+                << openvr_trackers_module::DefaultOutputConvention;
+    }
+    else if (const auto convention =
+                 openvr_trackers_module::ParseOutputConvention(
+                     rf.find("outputConvention").asString())) {
+        m_config.convention = convention.value();
+    }
+    else {
+        yWarning() << openvr_trackers_module::LogPrefix
+                   << "Invalid inserted outputConvention value:"
+                   << rf.find("outputConvention").asString()
+                   << ", using the default value: openvr";
+    }
+
+    // Try to find the "predictionTime" entry
+    if (!(openvr_common::FindNumber(
+              rf, "predictionTime", m_config.predictionTime)
+          && m_config.predictionTime >= 0.0
+          && m_config.predictionTime
+                 <= openvr_trackers_module::MaxPredictionTime)) {
+        yError() << openvr_trackers_module::LogPrefix
+                 << "The predictionTime must be a number in [0,"
+                 << openvr_trackers_module::MaxPredictionTime << "] seconds.";
+        return false;
+    }
+
+    // Try to find the pose processing entries
+    openvr::PoseProcessingOptions& processing = m_config.processing;
+    if (rf.check("orthonormalize") && rf.find("orthonormalize").isBool()) {
+        processing.orthonormalize = rf.find("orthonormalize").asBool();
+    }
+    if (rf.check("quaternionContinuity")
+        && rf.find("quaternionContinuity").isBool()) {
+        processing.quaternionContinuity =
+            rf.find("quaternionContinuity").asBool();
+    }
+    yInfo() << openvr_trackers_module::LogPrefix
+            << "Pose processing: orthonormalize =" << processing.orthonormalize
+            << ", quaternionContinuity =" << processing.quaternionContinuity;
+
+    // Try to find the "historyDuration" entry
+    double historyDuration = openvr_trackers_module::DefaultHistoryDuration;
+    if (!rf.check("historyDuration")) {
+        yInfo() << openvr_trackers_module::LogPrefix
+                << "Using default historyDuration:"
+                << openvr_trackers_module::DefaultHistoryDuration << "s";
+    }
+    if (!(openvr_common::FindNumber(rf, "historyDuration", historyDuration)
+          && historyDuration > 0.0)) {
+        yError() << openvr_trackers_module::LogPrefix
+                 << "The historyDuration must be a positive number.";
+        return false;
+    }
+
+    // Try to find the entries of the compressed tier of the history
+    openvr::PoseArchiveOptions archive;
+    archive.duration =
+        rf.check("historyArchiveDuration", yarp::os::Value(0.0)).asFloat64();
+    // The memory is given in MiB
+    constexpr double MiB = 1024.0 * 1024.0;
+    const double archiveMemory =
+        rf.check("historyArchiveMemory",
+                 yarp::os::Value(archive.maxBytesPerDevice / MiB))
+            .asFloat64();
+    if (archiveMemory > 0.0) {
+        archive.maxBytesPerDevice = static_cast<size_t>(MiB * archiveMemory);
+    }
+    if (rf.check("historyPositionResolution")) {
+        archive.positionResolution =
+            rf.find("historyPositionResolution").asFloat64();
+    }
+    if (!(archive.duration >= 0.0 && archive.positionResolution > 0.0
+          && archiveMemory > 0.0)) {
+        yError() << openvr_trackers_module::LogPrefix
+                 << "Invalid configuration of the history archive.";
+        return false;
+    }
+    if (archive.duration > 0.0) {
+        yInfo() << openvr_trackers_module::LogPrefix << "Archiving"
+                << archive.duration << "s of history, up to"
+                << archiveMemory << "MiB per device";
+    }
+
+    m_history =
+        std::make_unique<openvr::PoseHistory>(historyDuration, archive);
+
+    // Try to find the "upsampleRate" entry
+    double upsampleRate = 0.0;
+    if (!(openvr_common::FindNumber(rf, "upsampleRate", upsampleRate)
+          && upsampleRate >= 0.0)) {
+        yError() << openvr_trackers_module::LogPrefix
+                 << "The upsampling rate must be a positive number.";
+        return false;
+    }
+    if (upsampleRate > 0.0) {
+        if (upsampleRate * m_config.period <= 1.0) {
+            yError() << openvr_trackers_module::LogPrefix
+                     << "The upsampling rate must be higher than the rate"
+                     << "of the module (" << 1.0 / m_config.period << "Hz).";
+            return false;
         }
-        else {
-            vrOrigin = openvr::TrackingUniverseOrigin::Seated;
-            yWarning() << openvr_trackers_module::LogPrefix
-                << "Invalid inserted vrOrigin value: " << vrOriginString << ", using the default value: seated" ;
+
+        openvr::UpsamplingOptions upsampling;
+        upsampling.correctionTime = m_config.period;
+        m_upsampleCorrectionFromPeriod = !rf.check("upsampleCorrectionTime");
+        if (!(openvr_common::FindNumber(
+                  rf, "upsampleMaxExtrapolation", upsampling.maxExtrapolation)
+              && openvr_common::FindNumber(
+                  rf, "upsampleCorrectionTime", upsampling.correctionTime)
+              && upsampling.maxExtrapolation > 0.0
+              && upsampling.correctionTime > 0.0)) {
+            yError() << openvr_trackers_module::LogPrefix
+                     << "The upsampling extrapolation and correction times"
+                     << "must be positive numbers.";
+            return false;
         }
+
+        m_upsampler = std::make_unique<openvr::PoseUpsampler>(upsampling);
+        m_upsamplePeriod = 1.0 / upsampleRate;
+        yInfo() << openvr_trackers_module::LogPrefix
+                << "Publishing the poses at" << upsampleRate << "Hz,"
+                << "extrapolated up to" << upsampling.maxExtrapolation << "s";
     }
 
     // Create configuration of the "transformClient" device
@@ -150,29 +497,225 @@ bool OpenVRTrackersModule::configure(yarp::os::ResourceFinder& rf)
     m_sendBuffer.resize(4, 4);
     m_sendBuffer.eye();
 
+    // Try to find the "tfParentFrameName" entry
+    if (rf.check("tfParentFrameName")
+        && rf.find("tfParentFrameName").isString()) {
+        ParentFrame parent;
+        parent.name = rf.find("tfParentFrameName").asString();
+        parent.timeout =
+            rf.check("parentTimeout",
+                     yarp::os::Value(
+                         openvr_trackers_module::DefaultParentTimeout))
+                .asFloat64();
+
+        const std::string source =
+            rf.check("parentSource", yarp::os::Value("tf")).asString();
+        if (source == "port") {
+            parent.fromPort = true;
+        }
+        else if (source != "tf") {
+            yError() << openvr_trackers_module::LogPrefix
+                     << "Invalid parentSource value:" << source
+                     << "(supported: tf, port)";
+            return false;
+        }
+
+        if (parent.fromPort && !m_parentPort.open("/" + name + "/parent:i")) {
+            yError() << openvr_trackers_module::LogPrefix << "Could not open"
+                     << "/" + name + "/parent:i" << "port.";
+            return false;
+        }
+
+        m_parentBuffer.resize(4, 4);
+        m_parentBuffer.eye();
+
+        yInfo() << openvr_trackers_module::LogPrefix
+                << "Publishing the devices in the parent frame" << parent.name
+                << "read from the" << (parent.fromPort ? "port" : "tf");
+        m_parent = std::move(parent);
+    }
+
+    // Open the heartbeat port, read by the standby instances if any
+    if (!m_heartbeatPort.open("/" + name + "/heartbeat:o")) {
+        yError() << openvr_trackers_module::LogPrefix << "Could not open"
+                 << "/" + name + "/heartbeat:o" << "port.";
+        return false;
+    }
+
+    // Try to find the "standby" entry, with the name of the primary
+    if (rf.check("standby") && rf.find("standby").isString()) {
+        Failover failover;
+        failover.primaryPort =
+            "/" + rf.find("standby").asString() + "/heartbeat:o";
+        failover.timeout =
+            rf.check("heartbeatTimeout", yarp::os::Value(0.0)).asFloat64();
+
+        const std::string input = "/" + name + "/heartbeat:i";
+        if (!m_primaryHeartbeatPort.open(input)) {
+            yError() << openvr_trackers_module::LogPrefix << "Could not open"
+                     << input << "port.";
+            return false;
+        }
+
+        // The name server restores the connection whenever the primary
+        // opens its port again, without polling from the cycle
+        yarp::os::ContactStyle style;
+        style.persistent = true;
+        if (!yarp::os::Network::connect(failover.primaryPort, input, style)) {
+            yError() << openvr_trackers_module::LogPrefix
+                     << "Could not subscribe to" << failover.primaryPort;
+            return false;
+        }
+
+        // The standby waits a full timeout before publishing, also if the
+        // primary is not running yet
+        failover.lastBeat = yarp::os::Time::now();
+
+        yInfo() << openvr_trackers_module::LogPrefix
+                << "Running as standby of" << failover.primaryPort;
+        m_failover = std::move(failover);
+    }
+
+    // Create the OpenVR driver, optionally connected to a simulated runtime
+    const std::string runtime =
+        rf.check("runtime", yarp::os::Value("openvr")).asString();
+    if (runtime == "simulated") {
+        auto simulated = std::make_unique<openvr::SimulatedRuntime>();
+        simulated->setTimestampEmbedding(
+            rf.check("simulatedTimestamps", yarp::os::Value(false)).asBool());
+
+        const int simulatedDevices =
+            rf.check("simulatedDevices",
+                     yarp::os::Value(
+                         openvr_trackers_module::DefaultSimulatedDevices))
+                .asInt32();
+
+        // The index 0 is reserved to the HMD
+        simulated->connectDevice(0, "SIM-HMD", vr::TrackedDeviceClass_HMD);
+        for (int i = 1; i <= simulatedDevices; ++i) {
+            simulated->connectDevice(i, "SIM-" + std::to_string(i));
+        }
+
+        yInfo() << openvr_trackers_module::LogPrefix
+                << "Using a simulated runtime with" << simulatedDevices
+                << "trackers";
+        m_manager =
+            std::make_unique<openvr::DevicesManager>(std::move(simulated));
+    }
+    else if (runtime == "openvr") {
+        m_manager = std::make_unique<openvr::DevicesManager>();
+    }
+    else {
+        yError() << openvr_trackers_module::LogPrefix
+                 << "Invalid runtime value:" << runtime
+                 << "(supported: openvr, simulated)";
+        return false;
+    }
+
+    // Start with the devices of the previous session, if any
+    if (rf.check("deviceRegistry")) {
+        auto registry = std::make_shared<openvr::DeviceRegistry>(
+            rf.find("deviceRegistry").asString());
+
+        if (!registry->load()) {
+            yInfo() << openvr_trackers_module::LogPrefix
+                    << "No valid device registry found in" << registry->path()
+                    << ", it will be created";
+        }
+        m_manager->setDeviceRegistry(registry);
+    }
+
     // Initialize the OpenVR driver
-    if (!m_manager.initialize(vrOrigin)) {
+    if (!m_manager->initialize(m_config.vrOrigin, m_config.convention)) {
         yError() << openvr_trackers_module::LogPrefix
                  << "Failed to initialize the OpenVR devices manager.";
         return false;
     }
 
-    if (!m_manager.resetSeatedPosition())
+    m_manager->setPoseProcessing(m_config.processing);
+    m_manager->setPredictionTime(m_config.predictionTime);
+
+    if (!m_manager->resetSeatedPosition())
     {
         yError() << openvr_trackers_module::LogPrefix << "Failed to reset seated position.";
         return false;
     }
 
+    // Try to find the "skeletal" entry
+    if (rf.check("skeletal") && rf.find("skeletal").asBool()) {
+        if (!m_manager->enableSkeletalInput()) {
+            yError() << openvr_trackers_module::LogPrefix
+                     << "Failed to enable the skeletal input.";
+            return false;
+        }
+
+        if (!m_skeletalPort.open("/" + name + "/skeletal:o")) {
+            yError() << openvr_trackers_module::LogPrefix << "Could not open"
+                     << "/" + name + "/skeletal:o" << "port.";
+            return false;
+        }
+        m_skeletal = true;
+    }
+
+    // Try to find the "workspace" entry
+    if (rf.check("workspace")) {
+        if (!rf.find("workspace").isList()) {
+            yError() << openvr_trackers_module::LogPrefix
+                     << "The workspace must be a list of volumes.";
+            return false;
+        }
+        m_workspaceConfig = *rf.find("workspace").asList();
+
+        const auto volumes = this->buildWorkspace();
+        if (!volumes.has_value()) {
+            return false;
+        }
+
+        const double hysteresis =
+            rf.check("workspaceHysteresis",
+                     yarp::os::Value(
+                         openvr_trackers_module::DefaultWorkspaceHysteresis))
+                .asFloat64();
+
+        m_workspace = std::make_unique<openvr::WorkspaceMonitor>(
+            volumes.value(), hysteresis);
+
+        if (!m_workspacePort.open("/" + name + "/workspace:o")) {
+            yError() << openvr_trackers_module::LogPrefix << "Could not open"
+                     << "/" + name + "/workspace:o" << "port.";
+            return false;
+        }
+
+        yInfo() << openvr_trackers_module::LogPrefix << "Monitoring"
+                << volumes->size() << "workspace volume(s)";
+    }
+
+    // Open the haptics port. The commands are queued, so that none of them
+    // is dropped if several arrive while a pulse is being issued.
+    m_hapticsPort.setStrict();
+    if (!m_hapticsPort.open("/" + name + "/haptics:i")) {
+        yError() << openvr_trackers_module::LogPrefix << "Could not open"
+                 << "/" + name + "/haptics:i" << "port.";
+        return false;
+    }
+
     // Bind the RPC service to the module's object
     this->yarp().attachAsServer(this->m_rpcPort);
 
-    if(!m_rpcPort.open("/" + openvr_trackers_module::ModuleName +  + "/rpc"))
+    if(!m_rpcPort.open("/" + name + "/rpc"))
     {
         yError() << openvr_trackers_module::LogPrefix << "Could not open"
-                 << "/" + openvr_trackers_module::ModuleName +  + "/rpc" << " RPC port.";
+                 << "/" + name + "/rpc" << " RPC port.";
         return false;
     }
 
+    // The threads are started last, since close() is not called if the
+    // configuration fails
+    m_hapticsThread = std::thread([this] { this->hapticsLoop(); });
+    if (m_upsampler) {
+        m_upsampleThread = std::thread([this] { this->upsampleLoop(); });
+    }
+
     return true;
 }
 
@@ -180,68 +723,159 @@ double OpenVRTrackersModule::getPeriod()
 {
     const auto lock = std::unique_lock(m_mutex);
 
-    return m_period;
+    return m_config.period;
 }
 
 bool OpenVRTrackersModule::updateModule()
 {
     const auto lock = std::unique_lock(m_mutex);
 
+    // Apply the configuration changes requested since the last cycle
+    this->applyPendingConfiguration();
+
     // compute the poses
-    m_manager.computePoses();
+    const double timestamp = yarp::os::Time::now();
+    m_manager->computePoses();
+    const auto managedDevices = m_manager->managedDevices();
+
+    // Drop the history of the devices that left since the last cycle
+    std::unordered_set<std::string> currentDevices(managedDevices.begin(),
+                                                   managedDevices.end());
+    for (const auto& previous : m_previousDevices) {
+        if (currentDevices.count(previous) == 0) {
+            m_history->remove(previous);
+            if (m_upsampler) {
+                m_upsampler->remove(previous);
+            }
+        }
+    }
+    m_previousDevices.swap(currentDevices);
+    m_cycleSamples.clear();
+    m_transforms.clear();
+
     // Iterate over all the managed devices of the driver
-    for (const auto& sn : m_manager.managedDevices()) {
-
-        if (const auto& poseOpt = m_manager.pose(sn); poseOpt.has_value()) {
-
-            // Extract the pose of the device
-            const openvr::Pose& pose = poseOpt.value();
-
-            // Compute the prefix of the transform based on the device type.
-            // The final name will be "{tf_name_prefix}/{serial_number}".
-            const std::string tfNamePrefix = [&]() {
-                std::string prefix;
-
-                switch (m_manager.type(sn)) {
-                    case openvr::TrackedDeviceType::HMD:
-                        prefix = "/hmd/";
-                        break;
-                    case openvr::TrackedDeviceType::Controller:
-                        prefix = "/controllers/";
-                        break;
-                    case openvr::TrackedDeviceType::GenericTracker:
-                        prefix = "/trackers/";
-                        break;
-                    default:
-                        break;
-                }
-                return prefix;
-            }();
+    for (const auto& sn : managedDevices) {
 
-            // Reset the transform
-            m_sendBuffer.eye();
+        DeviceSample sample;
+        sample.serialNumber = sn;
+        sample.type = m_manager->type(sn);
+        sample.frameName =
+            openvr_trackers_module::FrameName(sample.type, sn);
+        sample.timestamp = timestamp;
+        sample.pose = m_manager->pose(sn);
+        if (m_skeletal) {
+            sample.skeletal = m_manager->skeletalSummary(sn);
+        }
 
-            // Fill the rotation of the transform using the row-major
-            // serialization used by the driver
-            m_sendBuffer[0][0] = pose.rotationRowMajor[0];
-            m_sendBuffer[0][1] = pose.rotationRowMajor[1];
-            m_sendBuffer[0][2] = pose.rotationRowMajor[2];
-            m_sendBuffer[1][0] = pose.rotationRowMajor[3];
-            m_sendBuffer[1][1] = pose.rotationRowMajor[4];
-            m_sendBuffer[1][2] = pose.rotationRowMajor[5];
-            m_sendBuffer[2][0] = pose.rotationRowMajor[6];
-            m_sendBuffer[2][1] = pose.rotationRowMajor[7];
-            m_sendBuffer[2][2] = pose.rotationRowMajor[8];
+        if (sample.pose.has_value()) {
+            m_transforms.push_back(
+                openvr_trackers_module::ToTransform(sample.pose.value()));
+            m_history->push(sn, timestamp, sample.pose.value());
+            if (m_upsampler) {
+                m_upsampler->push(sn, timestamp, sample.pose.value());
+            }
+        }
+        else if (m_upsampler) {
+            // Do not extrapolate from the pose before the tracking was lost
+            m_upsampler->remove(sn);
+        }
 
-            // Fill the position of the transform
-            m_sendBuffer[0][3] = pose.position[0];
-            m_sendBuffer[1][3] = pose.position[1];
-            m_sendBuffer[2][3] = pose.position[2];
+        m_cycleSamples.push_back(std::move(sample));
+    }
 
-            // Publish the transform
-            m_tf->setTransform(tfNamePrefix + sn, m_baseFrame, m_sendBuffer);
+    // A standby instance publishes only while its primary is silent
+    const bool active = !m_failover || this->updateFailover(timestamp);
 
+    // Express all the poses in the parent frame, if any. Without a recent
+    // transform of the parent frame nothing is published, rather than
+    // publishing the devices in the wrong place.
+    std::string parentFrame = m_config.baseFrame;
+    bool publish = active;
+    if (m_parent) {
+        publish = this->updateParentFrame(timestamp) && active;
+        if (publish) {
+            openvr_trackers_module::ComposeAll(m_parent->transform,
+                                               m_transforms);
         }
+        parentFrame = m_parent->name;
+    }
+
+    // Hand over the frames to the upsampling thread, that publishes them
+    if (m_upsampler) {
+        const auto upsampleLock = std::unique_lock(m_upsampleMutex);
+        m_upsampledFrames.clear();
+        for (const auto& sample : m_cycleSamples) {
+            if (sample.pose.has_value()) {
+                m_upsampledFrames.push_back(
+                    {sample.serialNumber, sample.frameName});
+            }
+        }
+        m_upsampledParentFrame = parentFrame;
+        m_upsampledParent.reset();
+        if (m_parent) {
+            m_upsampledParent = m_parent->transform;
+        }
+        m_upsamplePublish = publish;
+    }
+
+    // Publish the transforms
+    const auto tfLock = std::unique_lock(m_tfMutex);
+    size_t next = 0;
+    for (const auto& sample : m_cycleSamples) {
+        if (!(publish && !m_upsampler && sample.pose.has_value())) {
+            continue;
+        }
+        const Transform& transform = m_transforms[next++];
+
+        // The last row of the buffer is always (0 0 0 1)
+        for (size_t row = 0; row < 3; ++row) {
+            for (size_t col = 0; col < 4; ++col) {
+                m_sendBuffer[row][col] = transform[4 * row + col];
+            }
+        }
+
+        m_tf->setTransform(sample.frameName, parentFrame, m_sendBuffer);
+    }
+
+    if (m_skeletal && active) {
+        this->publishSkeletal(timestamp);
+    }
+
+    if (active) {
+        yarp::os::Bottle& heartbeat = m_heartbeatPort.prepare();
+        heartbeat.clear();
+        heartbeat.addInt64(m_stats.cycles);
+        heartbeat.addFloat64(timestamp);
+        m_heartbeatPort.write();
+    }
+
+    // Check the workspace before the samples are handed over. A standby
+    // instance leaves the events to its primary.
+    if (m_workspace && active) {
+        this->checkWorkspace(timestamp);
+    }
+
+    // Expose the samples of this cycle to the RPC clients
+    {
+        const auto snapshotLock = std::unique_lock(m_snapshotMutex);
+        m_snapshot.swap(m_cycleSamples);
+    }
+
+    // Update the statistics of the loop
+    {
+        const auto configLock = std::unique_lock(m_configMutex);
+        if (m_stats.cycles > 0) {
+            constexpr double Smoothing = 0.05;
+            m_stats.measuredPeriod +=
+                Smoothing
+                * ((timestamp - m_lastCycleTimestamp) - m_stats.measuredPeriod);
+        }
+        else {
+            m_stats.measuredPeriod = m_config.period;
+        }
+        m_stats.cycles++;
+        m_stats.period = m_config.period;
+        m_lastCycleTimestamp = timestamp;
     }
 
     return true;
@@ -251,8 +885,45 @@ bool OpenVRTrackersModule::close()
 {
     const auto lock = std::unique_lock(m_mutex);
 
+    // Stop the publishing of the upsampled poses before the transform client
+    if (m_upsampleThread.joinable()) {
+        {
+            const auto upsampleLock = std::unique_lock(m_upsampleMutex);
+            m_stopUpsampling = true;
+        }
+        m_upsampleWakeUp.notify_all();
+        m_upsampleThread.join();
+    }
+
+    // Stop the haptics thread before the devices manager goes away
+    m_hapticsPort.interrupt();
+    if (m_hapticsThread.joinable()) {
+        m_hapticsThread.join();
+    }
+    m_hapticsPort.close();
+
     m_driver.close();
     m_rpcPort.close();
+    m_workspacePort.close();
+    m_parentPort.close();
+    m_skeletalPort.close();
+    m_heartbeatPort.close();
+
+    // Remove the subscription from the name server
+    if (m_failover) {
+        yarp::os::ContactStyle style;
+        style.persistent = true;
+        yarp::os::Network::disconnect(m_failover->primaryPort,
+                                      m_primaryHeartbeatPort.getName(),
+                                      style);
+        m_failover.reset();
+    }
+    m_primaryHeartbeatPort.close();
+
+    if (m_asyncLog) {
+        openvr_log::Uninstall();
+        m_asyncLog = false;
+    }
     return true;
 }
 
@@ -260,7 +931,7 @@ bool OpenVRTrackersModule::resetSeatedPosition()
 {
     const auto lock = std::unique_lock(m_mutex);
 
-    if (!m_manager.resetSeatedPosition())
+    if (!m_manager->resetSeatedPosition())
     {
         yError() << openvr_trackers_module::LogPrefix << "Failed to reset seated position.";
         return false;
@@ -268,3 +939,759 @@ bool OpenVRTrackersModule::resetSeatedPosition()
 
     return true;
 }
+
+std::vector<DeviceInfo> OpenVRTrackersModule::listDevices()
+{
+    const auto lock = std::unique_lock(m_snapshotMutex);
+
+    std::vector<DeviceInfo> devices;
+    devices.reserve(m_snapshot.size());
+
+    for (const auto& sample : m_snapshot) {
+        DeviceInfo info;
+        info.serialNumber = sample.serialNumber;
+        info.type = openvr_trackers_module::TypeName(sample.type);
+        info.frameName = sample.frameName;
+        devices.push_back(std::move(info));
+    }
+
+    return devices;
+}
+
+std::vector<DevicePose> OpenVRTrackersModule::getAllPoses()
+{
+    const auto lock = std::unique_lock(m_snapshotMutex);
+
+    std::vector<DevicePose> poses;
+    poses.reserve(m_snapshot.size());
+
+    for (const auto& sample : m_snapshot) {
+        DevicePose pose;
+        pose.serialNumber = sample.serialNumber;
+        pose.frameName = sample.frameName;
+        pose.timestamp = sample.timestamp;
+        pose.valid = sample.pose.has_value();
+
+        if (sample.pose.has_value()) {
+            pose.position.assign(sample.pose->position.begin(),
+                                 sample.pose->position.end());
+            pose.quaternion.assign(sample.pose->quaternion.begin(),
+                                   sample.pose->quaternion.end());
+        }
+
+        poses.push_back(std::move(pose));
+    }
+
+    return poses;
+}
+
+std::vector<DevicePose>
+OpenVRTrackersModule::getHistory(const std::string& serial,
+                                 const double seconds)
+{
+    if (seconds <= 0.0) {
+        yError() << openvr_trackers_module::LogPrefix
+                 << "The history window must be positive.";
+        return {};
+    }
+
+    // Get the frame name from the latest snapshot
+    std::string frameName;
+    {
+        const auto lock = std::unique_lock(m_snapshotMutex);
+        const auto it = std::find_if(
+            m_snapshot.begin(), m_snapshot.end(), [&](const auto& sample) {
+                return sample.serialNumber == serial;
+            });
+
+        if (it == m_snapshot.end()) {
+            yError() << openvr_trackers_module::LogPrefix << "Device" << serial
+                     << "not found.";
+            return {};
+        }
+
+        frameName = it->frameName;
+    }
+
+    const double now = yarp::os::Time::now();
+    const auto samples = m_history->range(serial, now - seconds, now);
+
+    std::vector<DevicePose> poses;
+    poses.reserve(samples.size());
+
+    for (const auto& sample : samples) {
+        DevicePose pose;
+        pose.serialNumber = serial;
+        pose.frameName = frameName;
+        pose.timestamp = sample.timestamp;
+        pose.valid = true;
+        pose.position.assign(sample.pose.position.begin(),
+                             sample.pose.position.end());
+        pose.quaternion.assign(sample.pose.quaternion.begin(),
+                               sample.pose.quaternion.end());
+        poses.push_back(std::move(pose));
+    }
+
+    return poses;
+}
+
+bool OpenVRTrackersModule::setPeriod(const double period)
+{
+    if (!(period > 0.0)) {
+        yError() << openvr_trackers_module::LogPrefix
+                 << "The period must be positive.";
+        return false;
+    }
+
+    // As in configure, the poses must be upsampled to a higher rate
+    if (m_upsampler && period <= m_upsamplePeriod) {
+        yError() << openvr_trackers_module::LogPrefix
+                 << "The period must be longer than the upsampling period ("
+                 << m_upsamplePeriod << "s).";
+        return false;
+    }
+
+    return this->requestConfiguration(
+        "period " + std::to_string(period),
+        [&](Configuration& config) { config.period = period; });
+}
+
+bool OpenVRTrackersModule::setVrOrigin(const std::string& origin)
+{
+    const auto vrOrigin = openvr_trackers_module::ParseVrOrigin(origin);
+
+    if (!vrOrigin.has_value()) {
+        yError() << openvr_trackers_module::LogPrefix
+                 << "Invalid vrOrigin value:" << origin;
+        return false;
+    }
+
+    return this->requestConfiguration(
+        "vrOrigin " + origin,
+        [&](Configuration& config) { config.vrOrigin = vrOrigin.value(); });
+}
+
+bool OpenVRTrackersModule::setBaseFrameName(const std::string& name)
+{
+    if (name.empty()) {
+        yError() << openvr_trackers_module::LogPrefix
+                 << "The base frame name cannot be empty.";
+        return false;
+    }
+
+    return this->requestConfiguration(
+        "tfBaseFrameName " + name,
+        [&](Configuration& config) { config.baseFrame = name; });
+}
+
+bool OpenVRTrackersModule::setOutputConvention(const std::string& convention)
+{
+    const auto outputConvention =
+        openvr_trackers_module::ParseOutputConvention(convention);
+
+    if (!outputConvention.has_value()) {
+        yError() << openvr_trackers_module::LogPrefix
+                 << "Invalid outputConvention value:" << convention;
+        return false;
+    }
+
+    return this->requestConfiguration(
+        "outputConvention " + convention, [&](Configuration& config) {
+            config.convention = outputConvention.value();
+        });
+}
+
+bool OpenVRTrackersModule::setPredictionTime(const double seconds)
+{
+    if (!(seconds >= 0.0
+          && seconds <= openvr_trackers_module::MaxPredictionTime)) {
+        yError() << openvr_trackers_module::LogPrefix
+                 << "The prediction time must be in [0,"
+                 << openvr_trackers_module::MaxPredictionTime << "] seconds.";
+        return false;
+    }
+
+    return this->requestConfiguration(
+        "predictionTime " + std::to_string(seconds),
+        [&](Configuration& config) { config.predictionTime = seconds; });
+}
+
+bool OpenVRTrackersModule::setPoseProcessing(const bool orthonormalize,
+                                             const bool quaternionContinuity)
+{
+    return this->requestConfiguration(
+        std::string("orthonormalize ") + (orthonormalize ? "true" : "false")
+            + ", quaternionContinuity "
+            + (quaternionContinuity ? "true" : "false"),
+        [&](Configuration& config) {
+            config.processing.orthonormalize = orthonormalize;
+            config.processing.quaternionContinuity = quaternionContinuity;
+        });
+}
+
+ModuleStats OpenVRTrackersModule::getStats()
+{
+    ModuleStats stats;
+    {
+        const auto lock = std::unique_lock(m_configMutex);
+        stats = m_stats;
+    }
+
+    if (m_upsampler) {
+        const openvr::ExtrapolationError error = m_upsampler->error();
+        stats.extrapolationPositionError = error.position;
+        stats.extrapolationMaxPositionError = error.maxPosition;
+        stats.extrapolationOrientationError = error.orientation;
+        stats.extrapolationMaxOrientationError = error.maxOrientation;
+    }
+
+    const auto lock = std::unique_lock(m_hapticsMutex);
+    stats.hapticPulses = m_hapticStats.pulses;
+    stats.hapticCoalesced = m_hapticStats.coalesced;
+    stats.hapticRejected = m_hapticStats.rejected;
+    stats.hapticLatency = m_hapticStats.latency;
+    stats.hapticMaxLatency = m_hapticStats.maxLatency;
+    return stats;
+}
+
+bool OpenVRTrackersModule::requestConfiguration(
+    const std::string& description,
+    const std::function<void(Configuration&)>& change)
+{
+    const auto lock = std::unique_lock(m_configMutex);
+
+    // Changes requested within the same cycle are merged and applied
+    // together at the next cycle boundary
+    if (!m_pendingConfig.has_value()) {
+        m_pendingConfig = m_config;
+        m_pendingChanges.clear();
+    }
+
+    change(m_pendingConfig.value());
+    m_pendingChanges += (m_pendingChanges.empty() ? "" : "; ") + description;
+
+    yInfo() << openvr_trackers_module::LogPrefix
+            << "Configuration change requested:" << description;
+    return true;
+}
+
+void OpenVRTrackersModule::applyPendingConfiguration()
+{
+    const auto lock = std::unique_lock(m_configMutex);
+
+    if (!m_pendingConfig.has_value()) {
+        return;
+    }
+
+    const Configuration config = std::move(m_pendingConfig.value());
+    m_pendingConfig.reset();
+
+    if (config.vrOrigin != m_config.vrOrigin) {
+        m_manager->setTrackingUniverseOrigin(config.vrOrigin);
+    }
+    if (config.convention != m_config.convention) {
+        m_manager->setCoordinateConvention(config.convention);
+    }
+    if (config.predictionTime != m_config.predictionTime) {
+        m_manager->setPredictionTime(config.predictionTime);
+    }
+    if (config.processing.orthonormalize != m_config.processing.orthonormalize
+        || config.processing.quaternionContinuity
+               != m_config.processing.quaternionContinuity) {
+        m_manager->setPoseProcessing(config.processing);
+    }
+    if (config.period != m_config.period && m_upsampler
+        && m_upsampleCorrectionFromPeriod) {
+        m_upsampler->setCorrectionTime(config.period);
+    }
+
+    // The samples in the history are expressed in the old frame
+    if (config.vrOrigin != m_config.vrOrigin
+        || config.convention != m_config.convention
+        || config.baseFrame != m_config.baseFrame) {
+        m_history->clear();
+    }
+
+    // The play area is expressed in the frame of the poses as well
+    if (m_workspace
+        && (config.vrOrigin != m_config.vrOrigin
+            || config.convention != m_config.convention)) {
+        auto volumes = this->buildWorkspace();
+        if (!volumes.has_value()) {
+            yError() << openvr_trackers_module::LogPrefix
+                     << "Workspace monitoring disabled until the next"
+                     << "change of the origin or of the convention.";
+        }
+        m_workspace->reset(volumes.value_or(
+            std::vector<openvr::WorkspaceVolume>{}));
+    }
+
+    m_config = config;
+
+    m_stats.configurationChanges++;
+    m_stats.lastConfigurationChange = m_pendingChanges;
+    m_stats.lastConfigurationChangeTime = yarp::os::Time::now();
+
+    yInfo() << openvr_trackers_module::LogPrefix
+            << "Configuration changed:" << m_pendingChanges;
+}
+
+std::optional<std::vector<openvr::WorkspaceVolume>>
+OpenVRTrackersModule::buildWorkspace() const
+{
+    std::vector<openvr::WorkspaceVolume> volumes;
+
+    for (size_t i = 0; i < m_workspaceConfig.size(); ++i) {
+        const yarp::os::Bottle* entry = m_workspaceConfig.get(i).asList();
+        if (!entry) {
+            yError() << openvr_trackers_module::LogPrefix
+                     << "Invalid workspace volume:"
+                     << m_workspaceConfig.get(i).toString();
+            return std::nullopt;
+        }
+
+        const std::string name = entry->check("name")
+                                     ? entry->find("name").asString()
+                                     : "volume" + std::to_string(i);
+
+        // Axis aligned box, (box (xmin ymin zmin) (xmax ymax zmax))
+        if (entry->check("box")) {
+            const yarp::os::Bottle& box = entry->findGroup("box");
+            const auto min = openvr_trackers_module::ParseArray<3>(box.get(1));
+            const auto max = openvr_trackers_module::ParseArray<3>(box.get(2));
+
+            if (!(min.has_value() && max.has_value())) {
+                yError() << openvr_trackers_module::LogPrefix
+                         << "Invalid box of the workspace volume" << name;
+                return std::nullopt;
+            }
+            volumes.push_back(
+                openvr::WorkspaceVolume::Box(name, min.value(), max.value()));
+        }
+        // Half-spaces, (planes ((nx ny nz d) ...)) with n . p <= d inside
+        else if (entry->check("planes")) {
+            const yarp::os::Bottle* list = entry->find("planes").asList();
+            std::vector<std::array<double, 4>> planes;
+
+            bool valid = list && list->size() > 0;
+            for (size_t j = 0; valid && j < list->size(); ++j) {
+                const auto plane =
+                    openvr_trackers_module::ParseArray<4>(list->get(j));
+                valid = plane.has_value();
+                if (valid) {
+                    planes.push_back(plane.value());
+                }
+            }
+
+            auto volume =
+                valid ? openvr::WorkspaceVolume::HalfSpaces(name, planes)
+                      : std::nullopt;
+            if (!volume.has_value()) {
+                yError() << openvr_trackers_module::LogPrefix
+                         << "Invalid planes of the workspace volume" << name;
+                return std::nullopt;
+            }
+            volumes.push_back(std::move(volume.value()));
+        }
+        // Play area of the chaperone, (chaperone height)
+        else if (entry->check("chaperone")) {
+            const double height = entry->find("chaperone").asFloat64();
+            const auto area = m_manager->playArea();
+
+            if (!(height > 0.0 && area.has_value())) {
+                yError() << openvr_trackers_module::LogPrefix
+                         << "Cannot build the workspace volume" << name
+                         << "from the chaperone.";
+                return std::nullopt;
+            }
+            volumes.push_back(openvr::WorkspaceVolume::PlayAreaPrism(
+                name, area.value(), height));
+        }
+        else {
+            yError() << openvr_trackers_module::LogPrefix
+                     << "The workspace volume" << name
+                     << "needs one of box, planes or chaperone.";
+            return std::nullopt;
+        }
+    }
+
+    return volumes;
+}
+
+void OpenVRTrackersModule::checkWorkspace(const double timestamp)
+{
+    m_workspaceDevices.clear();
+    m_workspacePositions.clear();
+    m_workspaceEvents.clear();
+
+    // Devices without a usable pose keep their last state
+    for (const auto& sample : m_cycleSamples) {
+        if (sample.pose.has_value()) {
+            m_workspaceDevices.push_back(sample.serialNumber);
+            m_workspacePositions.push_back(sample.pose->position);
+        }
+    }
+
+    m_workspace->update(
+        m_workspaceDevices, m_workspacePositions, timestamp, m_workspaceEvents);
+
+    if (m_workspaceEvents.empty()) {
+        return;
+    }
+
+    // One message per cycle, with an element per crossing:
+    // (serial volume exit|enter distance timestamp)
+    yarp::os::Bottle& message = m_workspacePort.prepare();
+    message.clear();
+
+    for (const auto& event : m_workspaceEvents) {
+        yarp::os::Bottle& element = message.addList();
+        element.addString(event.serialNumber);
+        element.addString(event.volume);
+        element.addString(event.inside ? "enter" : "exit");
+        element.addFloat64(event.distance);
+        element.addFloat64(event.timestamp);
+
+        if (!event.inside) {
+            yWarning() << openvr_trackers_module::LogPrefix << "Device"
+                       << event.serialNumber << "left the workspace volume"
+                       << event.volume;
+        }
+    }
+
+    m_workspacePort.write();
+}
+
+void OpenVRTrackersModule::upsampleLoop()
+{
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(m_upsamplePeriod));
+
+    std::vector<UpsampledFrame> frames;
+    std::vector<Transform> transforms;
+    std::vector<const std::string*> published;
+    std::string parentFrame;
+    std::optional<Transform> parent;
+    yarp::sig::Matrix buffer(4, 4);
+    buffer.eye();
+
+    auto next = Clock::now();
+    auto lock = std::unique_lock(m_upsampleMutex);
+
+    while (!m_upsampleWakeUp.wait_until(
+        lock, next, [this] { return m_stopUpsampling; })) {
+
+        // Skip the ticks that were missed rather than bursting
+        next = std::max(next + period, Clock::now());
+
+        if (!m_upsamplePublish) {
+            continue;
+        }
+        frames = m_upsampledFrames;
+        parentFrame = m_upsampledParentFrame;
+        parent = m_upsampledParent;
+
+        // Publish without blocking the cycle
+        lock.unlock();
+
+        // The devices that lost the tracking since the cycle are skipped
+        const double timestamp = yarp::os::Time::now();
+        transforms.clear();
+        published.clear();
+        for (const auto& frame : frames) {
+            const auto pose =
+                m_upsampler->sample(frame.serialNumber, timestamp);
+            if (pose.has_value()) {
+                transforms.push_back(
+                    openvr_trackers_module::ToTransform(pose.value()));
+                published.push_back(&frame.frameName);
+            }
+        }
+        if (parent) {
+            openvr_trackers_module::ComposeAll(parent.value(), transforms);
+        }
+
+        {
+            const auto tfLock = std::unique_lock(m_tfMutex);
+            for (size_t i = 0; i < published.size(); ++i) {
+                for (size_t row = 0; row < 3; ++row) {
+                    for (size_t col = 0; col < 4; ++col) {
+                        buffer[row][col] = transforms[i][4 * row + col];
+                    }
+                }
+                m_tf->setTransform(*published[i], parentFrame, buffer);
+            }
+        }
+
+        lock.lock();
+    }
+}
+
+bool OpenVRTrackersModule::updateFailover(const double timestamp)
+{
+    Failover& failover = m_failover.value();
+
+    // Only the latest heartbeat is kept by the port
+    if (m_primaryHeartbeatPort.read(false)) {
+        failover.lastBeat = timestamp;
+    }
+
+    const double timeout =
+        failover.timeout > 0.0
+            ? failover.timeout
+            : openvr_trackers_module::HeartbeatCycles * m_config.period;
+    const bool active = timestamp - failover.lastBeat > timeout;
+
+    if (active != failover.active) {
+        if (active) {
+            yWarning() << openvr_trackers_module::LogPrefix
+                       << "No heartbeat from" << failover.primaryPort
+                       << "for" << timestamp - failover.lastBeat
+                       << "seconds, taking over the publishing.";
+        }
+        else {
+            yInfo() << openvr_trackers_module::LogPrefix
+                    << "Heartbeat from" << failover.primaryPort
+                    << "received, back to standby.";
+        }
+        failover.active = active;
+    }
+
+    return active;
+}
+
+bool OpenVRTrackersModule::updateParentFrame(const double timestamp)
+{
+    ParentFrame& parent = m_parent.value();
+    bool updated = false;
+
+    if (parent.fromPort) {
+        // Latest transform received, (x y z qw qx qy qz)
+        if (const yarp::os::Bottle* message = m_parentPort.read(false)) {
+            std::optional<Transform> transform;
+            if (message->size() == 7) {
+                std::array<double, 7> values;
+                for (size_t i = 0; i < values.size(); ++i) {
+                    values[i] = message->get(i).asFloat64();
+                }
+                transform = openvr_trackers_module::ToTransform(
+                    {values[0], values[1], values[2]},
+                    {values[3], values[4], values[5], values[6]});
+            }
+
+            if (transform.has_value()) {
+                parent.transform = transform.value();
+                parent.timestamp = timestamp;
+            }
+            else {
+                yError() << openvr_trackers_module::LogPrefix
+                         << "Invalid parent transform:" << message->toString();
+            }
+        }
+        updated = timestamp - parent.timestamp <= parent.timeout;
+    }
+    // Single lookup of the base frame in the parent frame, possibly through
+    // a chain of frames
+    else {
+        const auto tfLock = std::unique_lock(m_tfMutex);
+        if (m_tf->getTransform(
+                m_config.baseFrame, parent.name, m_parentBuffer)) {
+            for (size_t row = 0; row < 3; ++row) {
+                for (size_t col = 0; col < 4; ++col) {
+                    parent.transform[4 * row + col] = m_parentBuffer[row][col];
+                }
+            }
+            parent.timestamp = timestamp;
+            updated = true;
+        }
+    }
+
+    if (updated != parent.available) {
+        if (updated) {
+            yInfo() << openvr_trackers_module::LogPrefix
+                    << "Transform of the parent frame" << parent.name
+                    << "available, publishing the devices.";
+        }
+        else {
+            yWarning() << openvr_trackers_module::LogPrefix
+                       << "Transform of the parent frame" << parent.name
+                       << "not available, the devices are not published.";
+        }
+        parent.available = updated;
+    }
+
+    return updated;
+}
+
+void OpenVRTrackersModule::hapticsLoop()
+{
+    // The read returns nullptr when the port is interrupted
+    while (const yarp::os::Bottle* message = m_hapticsPort.read(true)) {
+        m_hapticCommands.clear();
+        size_t received = 0;
+        size_t rejected = 0;
+
+        // Drain all the queued messages, the commands are issued together
+        while (message) {
+            // The latency is measured from the time the command was sent,
+            // if the sender attached an envelope, or from its reception
+            double timestamp = yarp::os::Time::now();
+            yarp::os::Stamp stamp;
+            if (m_hapticsPort.getEnvelope(stamp) && stamp.isValid()) {
+                timestamp = stamp.getTime();
+            }
+
+            // Either a single command or a list of commands
+            if (message->size() > 0 && message->get(0).isList()) {
+                for (size_t i = 0; i < message->size(); ++i) {
+                    const yarp::os::Bottle* command = message->get(i).asList();
+                    received++;
+                    if (!(command
+                          && this->parseHapticCommand(*command, timestamp))) {
+                        rejected++;
+                    }
+                }
+            }
+            else {
+                received++;
+                if (!this->parseHapticCommand(*message, timestamp)) {
+                    rejected++;
+                }
+            }
+
+            message = m_hapticsPort.getPendingReads() > 0
+                          ? m_hapticsPort.read(false)
+                          : nullptr;
+        }
+
+        const size_t coalesced =
+            received - rejected - m_hapticCommands.size();
+
+        // Issue the pulses without waiting for the cycle
+        size_t pulses = 0;
+        double maxLatency = 0.0;
+        double latencySum = 0.0;
+        for (const auto& command : m_hapticCommands) {
+            if (!m_manager->triggerHapticPulse(
+                    command.serialNumber,
+                    command.axis,
+                    std::chrono::microseconds(
+                        static_cast<int64_t>(1e6 * command.duration)))) {
+                rejected++;
+                continue;
+            }
+
+            const double latency = yarp::os::Time::now() - command.timestamp;
+            latencySum += latency;
+            maxLatency = std::max(maxLatency, latency);
+            pulses++;
+        }
+
+        const auto lock = std::unique_lock(m_hapticsMutex);
+        m_hapticStats.coalesced += coalesced;
+        m_hapticStats.rejected += rejected;
+        if (pulses > 0) {
+            const double latency = latencySum / pulses;
+            m_hapticStats.latency =
+                m_hapticStats.pulses == 0
+                    ? latency
+                    : m_hapticStats.latency
+                          + openvr_trackers_module::HapticLatencySmoothing
+                                * (latency - m_hapticStats.latency);
+            m_hapticStats.maxLatency =
+                std::max(m_hapticStats.maxLatency, maxLatency);
+            m_hapticStats.pulses += pulses;
+        }
+    }
+}
+
+bool OpenVRTrackersModule::parseHapticCommand(const yarp::os::Bottle& command,
+                                              const double timestamp)
+{
+    // (target duration [axis]), with the target being either the serial
+    // number of a device or the role of a controller (left, right)
+    if (!(command.size() >= 2 && command.size() <= 3
+          && command.get(0).isString()
+          && (command.get(1).isFloat64() || command.get(1).isInt32()))) {
+        return false;
+    }
+
+    std::string serialNumber = command.get(0).asString();
+    if (const auto role = openvr_trackers_module::ParseRole(serialNumber)) {
+        const auto device = m_manager->deviceWithRole(role.value());
+        if (!device.has_value()) {
+            return false;
+        }
+        serialNumber = device.value();
+    }
+
+    const double duration = command.get(1).asFloat64();
+    const uint32_t axis =
+        command.size() > 2 ? static_cast<uint32_t>(command.get(2).asInt32())
+                           : 0;
+    if (!(duration > 0.0)) {
+        return false;
+    }
+
+    // Commands to the same axis of a device are merged, keeping the longest
+    // pulse and the time of the oldest command
+    for (auto& queued : m_hapticCommands) {
+        if (queued.serialNumber == serialNumber && queued.axis == axis) {
+            queued.duration = std::max(queued.duration, duration);
+            queued.timestamp = std::min(queued.timestamp, timestamp);
+            return true;
+        }
+    }
+
+    m_hapticCommands.push_back({serialNumber, axis, duration, timestamp});
+    return true;
+}
+
+void OpenVRTrackersModule::publishSkeletal(const double timestamp)
+{
+    // One message per cycle, with an element per hand:
+    // (serial timestamp level (curl x5) (splay x4) (x y z qw qx qy qz))
+    // The pose is the one published in the same cycle, empty if not valid.
+    yarp::os::Bottle& message = m_skeletalPort.prepare();
+    message.clear();
+
+    for (const auto& sample : m_cycleSamples) {
+        if (!sample.skeletal.has_value()) {
+            continue;
+        }
+        const openvr::SkeletalSummary& skeletal = sample.skeletal.value();
+
+        yarp::os::Bottle& element = message.addList();
+        element.addString(sample.serialNumber);
+        element.addFloat64(timestamp);
+        element.addInt32(static_cast<int>(skeletal.level));
+
+        yarp::os::Bottle& curl = element.addList();
+        for (const double value : skeletal.curl) {
+            curl.addFloat64(value);
+        }
+
+        yarp::os::Bottle& splay = element.addList();
+        for (const double value : skeletal.splay) {
+            splay.addFloat64(value);
+        }
+
+        yarp::os::Bottle& pose = element.addList();
+        if (sample.pose.has_value()) {
+            for (const double value : sample.pose->position) {
+                pose.addFloat64(value);
+            }
+            for (const double value : sample.pose->quaternion) {
+                pose.addFloat64(value);
+            }
+        }
+    }
+
+    if (message.size() == 0) {
+        m_skeletalPort.unprepare();
+        return;
+    }
+
+    m_skeletalPort.write();
+}
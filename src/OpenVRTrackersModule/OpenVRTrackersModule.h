@@ -12,16 +12,29 @@
 #define OPENVR_TRACKERS_MODULE_H
 
 #include "OpenVRTrackersDriver.h"
+#include "PoseHistory.h"
+#include "PoseUpsampler.h"
+#include "WorkspaceMonitor.h"
 #include <thrifts/OpenVRTrackersCommands.h>
 
 #include <yarp/dev/IFrameTransform.h>
 #include <yarp/dev/PolyDriver.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
 #include <yarp/os/RFModule.h>
 #include <yarp/sig/Matrix.h>
 #include <yarp/os/Port.h>
 
+#include <array>
+#include <condition_variable>
 #include <string>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 #include <cctype>
 #include <algorithm>
 
@@ -34,21 +47,205 @@ public:
     bool updateModule() override;
     bool close() override;
     bool resetSeatedPosition() override;
+    std::vector<DeviceInfo> listDevices() override;
+    std::vector<DevicePose> getAllPoses() override;
+    std::vector<DevicePose> getHistory(const std::string& serial,
+                                       const double seconds) override;
+    bool setPeriod(const double period) override;
+    bool setVrOrigin(const std::string& origin) override;
+    bool setBaseFrameName(const std::string& name) override;
+    bool setOutputConvention(const std::string& convention) override;
+    bool setPredictionTime(const double seconds) override;
+    bool setPoseProcessing(const bool orthonormalize,
+                           const bool quaternionContinuity) override;
+    ModuleStats getStats() override;
 
 private:
-    double m_period;
-    std::string m_baseFrame;
+    // Parameters that can be changed while the module is running
+    struct Configuration
+    {
+        double period;
+        std::string baseFrame;
+        openvr::TrackingUniverseOrigin vrOrigin =
+            openvr::TrackingUniverseOrigin::Seated;
+        openvr::CoordinateConvention convention =
+            openvr::CoordinateConvention::OpenVR;
+        double predictionTime = 0.0;
+        openvr::PoseProcessingOptions processing;
+    };
+
+    struct DeviceSample
+    {
+        std::string serialNumber;
+        std::string frameName;
+        openvr::TrackedDeviceType type;
+        double timestamp;
+        std::optional<openvr::Pose> pose;
+        std::optional<openvr::SkeletalSummary> skeletal;
+    };
+
+    // The active configuration is modified only by the module thread at
+    // the beginning of a cycle, the RPC setters stage their changes in the
+    // pending configuration
+    Configuration m_config;
+    std::optional<Configuration> m_pendingConfig;
+    std::string m_pendingChanges;
+    ModuleStats m_stats;
+    double m_lastCycleTimestamp = 0.0;
+
+    bool requestConfiguration(
+        const std::string& description,
+        const std::function<void(Configuration&)>& change);
+    void applyPendingConfiguration();
 
     yarp::sig::Matrix m_sendBuffer;
     yarp::dev::IFrameTransform* m_tf;
+    // The transform client is used by the cycle and by the upsampling thread
+    std::mutex m_tfMutex;
 
     yarp::dev::PolyDriver m_driver;
 
-    openvr::DevicesManager m_manager;
+    std::unique_ptr<openvr::DevicesManager> m_manager;
+
+    // Whether the asynchronous log sink was installed by the module
+    bool m_asyncLog = false;
 
     yarp::os::Port m_rpcPort;
 
+    // Samples of the latest cycle, served to the RPC clients without
+    // querying the runtime
+    std::vector<DeviceSample> m_snapshot;
+    std::vector<DeviceSample> m_cycleSamples;
+    // Serial numbers managed in the previous cycle, to find the devices
+    // that left
+    std::unordered_set<std::string> m_previousDevices;
+    std::unique_ptr<openvr::PoseHistory> m_history;
+
+    // Optional check of the positions of all the devices against the
+    // permitted volumes, evaluated in every cycle. The crossings are
+    // published on the workspace port in the same cycle.
+    std::unique_ptr<openvr::WorkspaceMonitor> m_workspace;
+    yarp::os::Bottle m_workspaceConfig;
+    yarp::os::BufferedPort<yarp::os::Bottle> m_workspacePort;
+    std::vector<std::string> m_workspaceDevices;
+    std::vector<std::array<double, 3>> m_workspacePositions;
+    std::vector<openvr::WorkspaceEvent> m_workspaceEvents;
+
+    std::optional<std::vector<openvr::WorkspaceVolume>> buildWorkspace() const;
+    void checkWorkspace(const double timestamp);
+
+    // Transforms of the devices of the latest cycle in the published
+    // parent frame, 3x4 row-major
+    using Transform = std::array<double, 12>;
+    std::vector<Transform> m_transforms;
+
+    // Optional parent frame moving with respect to the tracking space, e.g.
+    // the base of a mobile robot. Its transform is read once per cycle,
+    // either from the transform server or from the parent port, and
+    // composed with the poses of all the devices, that are then published
+    // as its children.
+    struct ParentFrame
+    {
+        std::string name;
+        bool fromPort = false;
+        double timeout;
+        // Transform of the base frame in the parent frame
+        Transform transform;
+        double timestamp = 0.0;
+        bool available = false;
+    };
+
+    std::optional<ParentFrame> m_parent;
+    yarp::os::BufferedPort<yarp::os::Bottle> m_parentPort;
+    yarp::sig::Matrix m_parentBuffer;
+
+    bool updateParentFrame(const double timestamp);
+
+    // Heartbeat written in every cycle in which the module publishes. A
+    // standby instance reads the one of its primary, computes the poses
+    // without publishing them and takes over when the heartbeat is missing
+    // for longer than the timeout, with the same frame names. It steps back
+    // as soon as the primary beats again.
+    struct Failover
+    {
+        std::string primaryPort;
+        // If not positive, HeartbeatCycles periods of the module
+        double timeout = 0.0;
+        double lastBeat = 0.0;
+        bool active = false;
+    };
+
+    yarp::os::BufferedPort<yarp::os::Bottle> m_heartbeatPort;
+    std::optional<Failover> m_failover;
+    yarp::os::BufferedPort<yarp::os::Bottle> m_primaryHeartbeatPort;
+
+    bool updateFailover(const double timestamp);
+
+    // Optional skeletons of the hands, sampled in the same cycle as the
+    // poses and published together with them in one message per cycle
+    bool m_skeletal = false;
+    yarp::os::BufferedPort<yarp::os::Bottle> m_skeletalPort;
+
+    void publishSkeletal(const double timestamp);
+
+    // Haptic commands, drained by a dedicated thread that calls the runtime
+    // as soon as they arrive. It does not take the lock of the cycle, so
+    // that the pulses are not delayed by the computation of the poses.
+    struct HapticCommand
+    {
+        std::string serialNumber;
+        uint32_t axis;
+        double duration;
+        double timestamp;
+    };
+
+    struct HapticStats
+    {
+        int64_t pulses = 0;
+        int64_t coalesced = 0;
+        int64_t rejected = 0;
+        double latency = 0.0;
+        double maxLatency = 0.0;
+    };
+
+    yarp::os::BufferedPort<yarp::os::Bottle> m_hapticsPort;
+    std::thread m_hapticsThread;
+    std::vector<HapticCommand> m_hapticCommands;
+    HapticStats m_hapticStats;
+    mutable std::mutex m_hapticsMutex;
+
+    void hapticsLoop();
+    bool parseHapticCommand(const yarp::os::Bottle& command,
+                            const double timestamp);
+
+    // Optional output at a higher rate than the cycle. The poses sampled by
+    // the cycle are extrapolated with their velocities and published by a
+    // dedicated thread, that takes the frames and the parent transform of
+    // the latest cycle.
+    struct UpsampledFrame
+    {
+        std::string serialNumber;
+        std::string frameName;
+    };
+
+    std::unique_ptr<openvr::PoseUpsampler> m_upsampler;
+    double m_upsamplePeriod = 0.0;
+    // Whether the correction time is not configured and follows the period
+    bool m_upsampleCorrectionFromPeriod = false;
+    std::thread m_upsampleThread;
+    bool m_stopUpsampling = false;
+    std::condition_variable m_upsampleWakeUp;
+    std::vector<UpsampledFrame> m_upsampledFrames;
+    std::string m_upsampledParentFrame;
+    std::optional<Transform> m_upsampledParent;
+    bool m_upsamplePublish = false;
+    mutable std::mutex m_upsampleMutex;
+
+    void upsampleLoop();
+
     mutable std::mutex m_mutex;
+    mutable std::mutex m_snapshotMutex;
+    mutable std::mutex m_configMutex;
 };
 
 #endif // OPENVR_TRACKERS_MODULE_H
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "OpenVRTrackersRuntime.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+// =============
+// NativeRuntime
+// =============
+
+openvr::NativeRuntime::~NativeRuntime()
+{
+    this->shutdown();
+}
+
+bool openvr::NativeRuntime::initialize(std::string& error)
+{
+    vr::EVRInitError eError = vr::VRInitError_None;
+
+    // Start the application in Background:
+    //
+    // The application will not start SteamVR.
+    // If it is not already running the call with VR_Init will fail
+    // with VRInitError_Init_NoServerForBackgroundApp.
+    //
+    // https://github.com/ValveSoftware/openvr/wiki/API-Documentation#initialization-and-cleanup
+    //
+    if (m_vr = vr::VR_Init(&eError, vr::VRApplication_Background); !m_vr) {
+        m_vr = nullptr;
+        error = vr::VR_GetVRInitErrorAsEnglishDescription(eError);
+        return false;
+    }
+
+    return true;
+}
+
+void openvr::NativeRuntime::shutdown()
+{
+    m_input = nullptr;
+    if (!m_manifestDirectory.empty()) {
+        std::error_code error;
+        std::filesystem::remove_all(m_manifestDirectory, error);
+        m_manifestDirectory.clear();
+    }
+
+    if (m_vr) {
+        m_vr = nullptr;
+        vr::VR_Shutdown();
+    }
+}
+
+bool openvr::NativeRuntime::running() const
+{
+    return m_vr && !std::string(m_vr->GetRuntimeVersion()).empty();
+}
+
+bool openvr::NativeRuntime::isTrackedDeviceConnected(
+    const vr::TrackedDeviceIndex_t index)
+{
+    return m_vr->IsTrackedDeviceConnected(index);
+}
+
+vr::ETrackedDeviceClass
+openvr::NativeRuntime::trackedDeviceClass(const vr::TrackedDeviceIndex_t index)
+{
+    return m_vr->GetTrackedDeviceClass(index);
+}
+
+std::string
+openvr::NativeRuntime::stringProperty(const vr::TrackedDeviceIndex_t index,
+                                      const vr::ETrackedDeviceProperty property)
+{
+    // Allocate the buffer using the maximum allowed size
+    char buffer[vr::k_unMaxPropertyStringSize];
+
+    // Get the string property
+    m_vr->GetStringTrackedDeviceProperty( //
+        index,
+        property,
+        buffer,
+        vr::k_unMaxPropertyStringSize);
+
+    // Convert to std::string
+    return std::string(buffer);
+}
+
+void openvr::NativeRuntime::deviceToAbsoluteTrackingPose(
+    const vr::ETrackingUniverseOrigin origin,
+    const float predictedSecondsFromNow,
+    vr::TrackedDevicePose_t* poses,
+    const uint32_t count)
+{
+    m_vr->GetDeviceToAbsoluteTrackingPose(
+        origin, predictedSecondsFromNow, poses, count);
+}
+
+bool openvr::NativeRuntime::pollNextEvent(vr::VREvent_t& event)
+{
+    return m_vr->PollNextEvent(&event, sizeof(event));
+}
+
+void openvr::NativeRuntime::acknowledgeQuit()
+{
+    m_vr->AcknowledgeQuit_Exiting();
+}
+
+void openvr::NativeRuntime::resetZeroPose(
+    const vr::ETrackingUniverseOrigin origin)
+{
+    vr::VRChaperone()->ResetZeroPose(origin);
+}
+
+bool openvr::NativeRuntime::playAreaRect(vr::HmdQuad_t& rect)
+{
+    vr::IVRChaperone* chaperone = vr::VRChaperone();
+    return chaperone && chaperone->GetPlayAreaRect(&rect);
+}
+
+vr::ETrackedControllerRole
+openvr::NativeRuntime::controllerRole(const vr::TrackedDeviceIndex_t index)
+{
+    return m_vr->GetControllerRoleForTrackedDeviceIndex(index);
+}
+
+void openvr::NativeRuntime::triggerHapticPulse(
+    const vr::TrackedDeviceIndex_t index,
+    const uint32_t axis,
+    const unsigned short durationUs)
+{
+    m_vr->TriggerHapticPulse(index, axis, durationUs);
+}
+
+bool openvr::NativeRuntime::enableSkeletalInput(std::string& error)
+{
+    m_input = vr::VRInput();
+    if (!m_input) {
+        error = "The input interface is not available";
+        return false;
+    }
+
+    // The input system needs an action manifest on disk, with a skeleton
+    // action per hand and its default binding for the Index controllers
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path()
+        / ("yarp-openvr-trackers-" + std::to_string(
+               std::chrono::steady_clock::now().time_since_epoch().count()));
+
+    std::error_code fsError;
+    std::filesystem::create_directories(directory, fsError);
+    if (fsError) {
+        error = "Failed to create " + directory.string();
+        return false;
+    }
+    m_manifestDirectory = directory.string();
+
+    std::ofstream(directory / "actions.json") << R"({
+  "default_bindings": [
+    {"controller_type": "knuckles", "binding_url": "bindings_knuckles.json"}
+  ],
+  "actions": [
+    {"name": "/actions/trackers/in/left_hand_skeleton", "type": "skeleton",
+     "skeleton": "/skeleton/hand/left"},
+    {"name": "/actions/trackers/in/right_hand_skeleton", "type": "skeleton",
+     "skeleton": "/skeleton/hand/right"}
+  ],
+  "action_sets": [{"name": "/actions/trackers", "usage": "leftright"}]
+})";
+
+    std::ofstream(directory / "bindings_knuckles.json") << R"({
+  "controller_type": "knuckles",
+  "bindings": {
+    "/actions/trackers": {
+      "skeleton": [
+        {"output": "/actions/trackers/in/left_hand_skeleton",
+         "path": "/user/hand/left/input/skeleton/left"},
+        {"output": "/actions/trackers/in/right_hand_skeleton",
+         "path": "/user/hand/right/input/skeleton/right"}
+      ]
+    }
+  }
+})";
+
+    const std::string manifest = (directory / "actions.json").string();
+    if (m_input->SetActionManifestPath(manifest.c_str())
+            != vr::VRInputError_None
+        || m_input->GetActionSetHandle("/actions/trackers", &m_actionSet)
+               != vr::VRInputError_None
+        || m_input->GetActionHandle("/actions/trackers/in/left_hand_skeleton",
+                                    &m_leftHandSkeleton)
+               != vr::VRInputError_None
+        || m_input->GetActionHandle("/actions/trackers/in/right_hand_skeleton",
+                                    &m_rightHandSkeleton)
+               != vr::VRInputError_None) {
+        error = "Failed to load the action manifest " + manifest;
+        m_input = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+bool openvr::NativeRuntime::updateSkeletalInput()
+{
+    if (!m_input) {
+        return false;
+    }
+
+    vr::VRActiveActionSet_t activeSet = {};
+    activeSet.ulActionSet = m_actionSet;
+    return m_input->UpdateActionState(&activeSet, sizeof(activeSet), 1)
+           == vr::VRInputError_None;
+}
+
+bool openvr::NativeRuntime::skeletalSummary(
+    const vr::ETrackedControllerRole hand,
+    vr::TrackedDeviceIndex_t& index,
+    vr::VRSkeletalSummaryData_t& summary,
+    vr::EVRSkeletalTrackingLevel& level)
+{
+    if (!m_input) {
+        return false;
+    }
+
+    const vr::VRActionHandle_t action =
+        hand == vr::TrackedControllerRole_LeftHand ? m_leftHandSkeleton
+                                                   : m_rightHandSkeleton;
+
+    vr::InputSkeletalActionData_t data;
+    if (m_input->GetSkeletalActionData(action, &data, sizeof(data))
+            != vr::VRInputError_None
+        || !data.bActive) {
+        return false;
+    }
+
+    vr::InputOriginInfo_t origin;
+    if (m_input->GetOriginTrackedDeviceInfo(
+            data.activeOrigin, &origin, sizeof(origin))
+        != vr::VRInputError_None) {
+        return false;
+    }
+    index = origin.trackedDeviceIndex;
+
+    return m_input->GetSkeletalSummaryData(
+               action, vr::VRSummaryType_FromDevice, &summary)
+               == vr::VRInputError_None
+           && m_input->GetSkeletalTrackingLevel(action, &level)
+                  == vr::VRInputError_None;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef OPENVR_TRACKERS_RUNTIME_H
+#define OPENVR_TRACKERS_RUNTIME_H
+
+#include <openvr.h>
+
+#include <string>
+
+namespace openvr {
+    class Runtime;
+    class NativeRuntime;
+} // namespace openvr
+
+// Subset of the OpenVR system API used by the DevicesManager. It allows
+// replacing the runtime, e.g. with a simulated one.
+class openvr::Runtime
+{
+public:
+    virtual ~Runtime() = default;
+
+    virtual bool initialize(std::string& error) = 0;
+    virtual void shutdown() = 0;
+    virtual bool running() const = 0;
+
+    virtual bool isTrackedDeviceConnected(const vr::TrackedDeviceIndex_t index) = 0;
+    virtual vr::ETrackedDeviceClass
+    trackedDeviceClass(const vr::TrackedDeviceIndex_t index) = 0;
+    virtual std::string
+    stringProperty(const vr::TrackedDeviceIndex_t index,
+                   const vr::ETrackedDeviceProperty property) = 0;
+
+    virtual void
+    deviceToAbsoluteTrackingPose(const vr::ETrackingUniverseOrigin origin,
+                                 const float predictedSecondsFromNow,
+                                 vr::TrackedDevicePose_t* poses,
+                                 const uint32_t count) = 0;
+
+    virtual bool pollNextEvent(vr::VREvent_t& event) = 0;
+    virtual void acknowledgeQuit() = 0;
+
+    virtual void resetZeroPose(const vr::ETrackingUniverseOrigin origin) = 0;
+
+    // Corners of the play area in the standing universe
+    virtual bool playAreaRect(vr::HmdQuad_t& rect) = 0;
+
+    virtual vr::ETrackedControllerRole
+    controllerRole(const vr::TrackedDeviceIndex_t index) = 0;
+    virtual void triggerHapticPulse(const vr::TrackedDeviceIndex_t index,
+                                    const uint32_t axis,
+                                    const unsigned short durationUs) = 0;
+
+    // Skeletal input of the hands, read through the input system with a
+    // skeleton action per hand. updateSkeletalInput() refreshes the state
+    // of all the actions, then skeletalSummary() reads a hand and the index
+    // of the device providing it.
+    virtual bool enableSkeletalInput(std::string& error) = 0;
+    virtual bool updateSkeletalInput() = 0;
+    virtual bool skeletalSummary(const vr::ETrackedControllerRole hand,
+                                 vr::TrackedDeviceIndex_t& index,
+                                 vr::VRSkeletalSummaryData_t& summary,
+                                 vr::EVRSkeletalTrackingLevel& level) = 0;
+};
+
+// The OpenVR runtime, connected as a background application
+class openvr::NativeRuntime final : public openvr::Runtime
+{
+public:
+    ~NativeRuntime() override;
+
+    bool initialize(std::string& error) override;
+    void shutdown() override;
+    bool running() const override;
+
+    bool isTrackedDeviceConnected(const vr::TrackedDeviceIndex_t index) override;
+    vr::ETrackedDeviceClass
+    trackedDeviceClass(const vr::TrackedDeviceIndex_t index) override;
+    std::string
+    stringProperty(const vr::TrackedDeviceIndex_t index,
+                   const vr::ETrackedDeviceProperty property) override;
+
+    void deviceToAbsoluteTrackingPose(const vr::ETrackingUniverseOrigin origin,
+                                      const float predictedSecondsFromNow,
+                                      vr::TrackedDevicePose_t* poses,
+                                      const uint32_t count) override;
+
+    bool pollNextEvent(vr::VREvent_t& event) override;
+    void acknowledgeQuit() override;
+
+    void resetZeroPose(const vr::ETrackingUniverseOrigin origin) override;
+
+    bool playAreaRect(vr::HmdQuad_t& rect) override;
+
+    vr::ETrackedControllerRole
+    controllerRole(const vr::TrackedDeviceIndex_t index) override;
+    void triggerHapticPulse(const vr::TrackedDeviceIndex_t index,
+                            const uint32_t axis,
+                            const unsigned short durationUs) override;
+
+    bool enableSkeletalInput(std::string& error) override;
+    bool updateSkeletalInput() override;
+    bool skeletalSummary(const vr::ETrackedControllerRole hand,
+                         vr::TrackedDeviceIndex_t& index,
+                         vr::VRSkeletalSummaryData_t& summary,
+                         vr::EVRSkeletalTrackingLevel& level) override;
+
+private:
+    vr::IVRSystem* m_vr = nullptr;
+
+    // Action manifest written at runtime, removed at shutdown
+    std::string m_manifestDirectory;
+    vr::IVRInput* m_input = nullptr;
+    vr::VRActionSetHandle_t m_actionSet = 0;
+    vr::VRActionHandle_t m_leftHandSkeleton = vr::k_ulInvalidActionHandle;
+    vr::VRActionHandle_t m_rightHandSkeleton = vr::k_ulInvalidActionHandle;
+};
+
+#endif // OPENVR_TRACKERS_RUNTIME_H
@@ -0,0 +1,313 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "PoseHistory.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+    // Quantized values of a sample: time, position and quaternion
+    constexpr size_t Fields = 8;
+    using Quantized = std::array<int64_t, Fields>;
+
+    // Every field of a sample takes at most 10 bytes as a varint
+    constexpr size_t MaxSampleBytes = 10 * Fields;
+    constexpr size_t BlockBytes = 4096;
+
+    // Samples encoded as the differences of their quantized values from the
+    // ones of the previous sample, with zigzag varints. The first sample is
+    // encoded with respect to zero, so that a block can be decoded alone.
+    struct Block
+    {
+        double firstTimestamp = 0.0;
+        double lastTimestamp = 0.0;
+        Quantized last = {};
+        uint32_t count = 0;
+        uint32_t size = 0;
+        std::array<uint8_t, BlockBytes> data;
+    };
+
+    void WriteVarint(uint8_t* data, uint32_t& size, const int64_t value)
+    {
+        uint64_t zigzag = (static_cast<uint64_t>(value) << 1)
+                          ^ static_cast<uint64_t>(value >> 63);
+        while (zigzag >= 0x80) {
+            data[size++] = static_cast<uint8_t>(zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        data[size++] = static_cast<uint8_t>(zigzag);
+    }
+
+    int64_t ReadVarint(const uint8_t* data, uint32_t& offset)
+    {
+        uint64_t zigzag = 0;
+        for (int shift = 0;; shift += 7) {
+            const uint8_t byte = data[offset++];
+            zigzag |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                break;
+            }
+        }
+        return static_cast<int64_t>(zigzag >> 1)
+               ^ -static_cast<int64_t>(zigzag & 1);
+    }
+
+    // Rotation matrix of a unit quaternion (w, x, y, z)
+    std::array<double, 9> ToRotation(const std::array<double, 4>& q)
+    {
+        const auto [w, x, y, z] = q;
+        return {1 - 2 * (y * y + z * z),
+                2 * (x * y - w * z),
+                2 * (x * z + w * y),
+                2 * (x * y + w * z),
+                1 - 2 * (x * x + z * z),
+                2 * (y * z - w * x),
+                2 * (x * z - w * y),
+                2 * (y * z + w * x),
+                1 - 2 * (x * x + y * y)};
+    }
+} // namespace
+
+// =================
+// PoseHistory::Impl
+// =================
+
+class openvr::PoseHistory::Impl
+{
+public:
+    double duration;
+    PoseArchiveOptions archive;
+    size_t maxBlocks;
+
+    struct Buffer
+    {
+        // Full precision window
+        std::deque<TimedPose> recent;
+        // Older samples, sorted by timestamp as well
+        std::deque<Block> blocks;
+    };
+
+    using TrackedDeviceSerialNumber = std::string;
+    std::unordered_map<TrackedDeviceSerialNumber, Buffer> buffers;
+
+    mutable std::mutex mutex;
+
+    Quantized quantize(const TimedPose& sample) const
+    {
+        const auto& p = sample.pose.position;
+        const auto& q = sample.pose.quaternion;
+        const double pr = archive.positionResolution;
+        const double qr = archive.quaternionResolution;
+
+        return {std::llround(sample.timestamp / archive.timeResolution),
+                std::llround(p[0] / pr),
+                std::llround(p[1] / pr),
+                std::llround(p[2] / pr),
+                std::llround(q[0] / qr),
+                std::llround(q[1] / qr),
+                std::llround(q[2] / qr),
+                std::llround(q[3] / qr)};
+    }
+
+    TimedPose dequantize(const Quantized& values) const
+    {
+        const double pr = archive.positionResolution;
+        const double qr = archive.quaternionResolution;
+
+        TimedPose sample;
+        sample.timestamp = values[0] * archive.timeResolution;
+        sample.pose.position = {values[1] * pr, values[2] * pr, values[3] * pr};
+
+        std::array<double, 4> q = {
+            values[4] * qr, values[5] * qr, values[6] * qr, values[7] * qr};
+        const double norm =
+            std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        if (norm > 0.0) {
+            for (auto& element : q) {
+                element /= norm;
+            }
+        }
+        sample.pose.quaternion = q;
+        sample.pose.rotationRowMajor = ToRotation(q);
+
+        return sample;
+    }
+
+    void archiveSample(Buffer& buffer, const TimedPose& sample) const
+    {
+        if (buffer.blocks.empty()
+            || buffer.blocks.back().size + MaxSampleBytes > BlockBytes) {
+            buffer.blocks.emplace_back();
+        }
+        Block& block = buffer.blocks.back();
+
+        const Quantized values = quantize(sample);
+        for (size_t i = 0; i < Fields; ++i) {
+            WriteVarint(
+                block.data.data(), block.size, values[i] - block.last[i]);
+        }
+
+        if (block.count == 0) {
+            block.firstTimestamp = sample.timestamp;
+        }
+        block.lastTimestamp = sample.timestamp;
+        block.last = values;
+        block.count++;
+    }
+
+    void decodeRange(const Block& block,
+                     const double from,
+                     const double to,
+                     std::vector<TimedPose>& samples) const
+    {
+        Quantized values = {};
+        uint32_t offset = 0;
+
+        for (uint32_t n = 0; n < block.count; ++n) {
+            for (size_t i = 0; i < Fields; ++i) {
+                values[i] += ReadVarint(block.data.data(), offset);
+            }
+
+            const double timestamp = values[0] * archive.timeResolution;
+            if (timestamp > to) {
+                break;
+            }
+            if (timestamp >= from) {
+                samples.push_back(dequantize(values));
+            }
+        }
+    }
+};
+
+// ===========
+// PoseHistory
+// ===========
+
+openvr::PoseHistory::PoseHistory(const double duration,
+                                 const PoseArchiveOptions& archive)
+    : pImpl{std::make_unique<Impl>()}
+{
+    pImpl->duration = duration;
+    pImpl->archive = archive;
+    pImpl->maxBlocks =
+        std::max<size_t>(1, archive.maxBytesPerDevice / sizeof(Block));
+}
+
+openvr::PoseHistory::~PoseHistory() = default;
+
+double openvr::PoseHistory::duration() const
+{
+    return pImpl->duration;
+}
+
+void openvr::PoseHistory::push(const std::string& serialNumber,
+                               const double timestamp,
+                               const Pose& pose)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    auto& buffer = pImpl->buffers[serialNumber];
+    auto& recent = buffer.recent;
+
+    recent.push_back({timestamp, pose});
+
+    // Move the samples that are older than the full precision window to the
+    // archive, if any
+    while (!recent.empty()
+           && recent.front().timestamp < timestamp - pImpl->duration) {
+        if (pImpl->archive.duration > 0.0) {
+            pImpl->archiveSample(buffer, recent.front());
+        }
+        recent.pop_front();
+    }
+
+    // Drop the blocks that are entirely older than the archive, or that
+    // exceed its memory
+    auto& blocks = buffer.blocks;
+    while (!blocks.empty()
+           && (blocks.front().lastTimestamp
+                   < timestamp - pImpl->duration - pImpl->archive.duration
+               || blocks.size() > pImpl->maxBlocks)) {
+        blocks.pop_front();
+    }
+}
+
+void openvr::PoseHistory::remove(const std::string& serialNumber)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->buffers.erase(serialNumber);
+}
+
+void openvr::PoseHistory::clear()
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->buffers.clear();
+}
+
+std::vector<openvr::TimedPose>
+openvr::PoseHistory::range(const std::string& serialNumber,
+                           const double from,
+                           const double to) const
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+
+    const auto it = pImpl->buffers.find(serialNumber);
+    if (it == pImpl->buffers.end()) {
+        return {};
+    }
+
+    std::vector<TimedPose> samples;
+
+    // The archived blocks are sorted by timestamp, only the ones
+    // overlapping the range are decoded
+    const auto& blocks = it->second.blocks;
+    auto block = std::lower_bound(
+        blocks.begin(), blocks.end(), from, [](const Block& b, const double t) {
+            return b.lastTimestamp < t;
+        });
+    for (; block != blocks.end() && block->firstTimestamp <= to; ++block) {
+        pImpl->decodeRange(*block, from, to, samples);
+    }
+
+    // The buffer is sorted by timestamp
+    const auto& buffer = it->second.recent;
+    const auto begin = std::lower_bound(
+        buffer.begin(),
+        buffer.end(),
+        from,
+        [](const TimedPose& sample, const double t) {
+            return sample.timestamp < t;
+        });
+    const auto end = std::upper_bound(
+        begin, buffer.end(), to, [](const double t, const TimedPose& sample) {
+            return t < sample.timestamp;
+        });
+
+    samples.insert(samples.end(), begin, end);
+    return samples;
+}
+
+std::optional<openvr::TimedPose>
+openvr::PoseHistory::latest(const std::string& serialNumber) const
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+
+    const auto it = pImpl->buffers.find(serialNumber);
+    if (it == pImpl->buffers.end() || it->second.recent.empty()) {
+        return std::nullopt;
+    }
+
+    return it->second.recent.back();
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef OPENVR_TRACKERS_POSE_HISTORY_H
+#define OPENVR_TRACKERS_POSE_HISTORY_H
+
+#include "OpenVRTrackersDriver.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace openvr {
+    struct TimedPose;
+    struct PoseArchiveOptions;
+    class PoseHistory;
+} // namespace openvr
+
+struct openvr::TimedPose
+{
+    double timestamp;
+    Pose pose;
+};
+
+// Optional second tier of the history, retaining the samples older than the
+// full precision window. They are quantized and delta-encoded in blocks of
+// fixed size, taking about a tenth of the memory of the full samples.
+struct openvr::PoseArchiveOptions
+{
+    // Seconds retained after the full precision window, 0 to disable
+    double duration = 0.0;
+    // Memory of the archive of each device (64 MiB), the oldest blocks are
+    // dropped when it is exceeded
+    size_t maxBytesPerDevice = 64 * 1024 * 1024;
+    // Quantization steps, in meters, quaternion units and seconds
+    double positionResolution = 1e-5;
+    double quaternionResolution = 1e-5;
+    double timeResolution = 1e-6;
+};
+
+// Thread-safe buffer storing the poses of the devices received in the last
+// `duration` seconds, followed by the archive if enabled. Samples must be
+// pushed with increasing timestamps.
+class openvr::PoseHistory
+{
+public:
+    PoseHistory(const double duration = 10.0,
+                const PoseArchiveOptions& archive = {});
+    ~PoseHistory();
+
+    double duration() const;
+
+    void push(const std::string& serialNumber,
+              const double timestamp,
+              const Pose& pose);
+    void remove(const std::string& serialNumber);
+    void clear();
+
+    // Return the samples of the device with timestamp in [from, to],
+    // ordered by increasing timestamp. The archived samples are decoded
+    // with the resolutions of the archive, and their rotation matrix is
+    // computed from the quaternion. The velocities are not archived, they
+    // are zero in the archived samples.
+    std::vector<TimedPose> range(const std::string& serialNumber,
+                                 const double from,
+                                 const double to) const;
+    std::optional<TimedPose> latest(const std::string& serialNumber) const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+#endif // OPENVR_TRACKERS_POSE_HISTORY_H
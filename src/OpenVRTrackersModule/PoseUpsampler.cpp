@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "PoseUpsampler.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+    // Quaternions are (w, x, y, z), as in openvr::Pose
+    using Quaternion = std::array<double, 4>;
+    using Vector = std::array<double, 3>;
+
+    constexpr double ErrorSmoothing = 0.05;
+
+    Quaternion Multiply(const Quaternion& a, const Quaternion& b)
+    {
+        return {a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3],
+                a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2],
+                a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1],
+                a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0]};
+    }
+
+    Quaternion Conjugate(const Quaternion& q)
+    {
+        return {q[0], -q[1], -q[2], -q[3]};
+    }
+
+    void Normalize(Quaternion& q)
+    {
+        const double norm =
+            std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        for (auto& element : q) {
+            element /= norm;
+        }
+    }
+
+    // Rotation of the given axis-angle vector
+    Quaternion FromRotationVector(const Vector& v)
+    {
+        const double angle = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        if (angle < 1e-12) {
+            return {1.0, 0.5 * v[0], 0.5 * v[1], 0.5 * v[2]};
+        }
+
+        const double s = std::sin(0.5 * angle) / angle;
+        return {std::cos(0.5 * angle), s * v[0], s * v[1], s * v[2]};
+    }
+
+    // Angle of the rotation, in [0, pi]
+    double Angle(const Quaternion& q)
+    {
+        const double sine = std::sqrt(q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        return 2.0 * std::atan2(sine, std::abs(q[0]));
+    }
+
+    // Fraction of the rotation along the shortest arc
+    Quaternion Scale(const Quaternion& q, const double fraction)
+    {
+        const double sign = q[0] < 0.0 ? -1.0 : 1.0;
+        const double angle = Angle(q);
+        const double sine = std::sin(0.5 * angle);
+        if (sine < 1e-12) {
+            return {1.0, 0.0, 0.0, 0.0};
+        }
+
+        const double s = sign * std::sin(0.5 * fraction * angle) / sine;
+        return {std::cos(0.5 * fraction * angle), s * q[1], s * q[2], s * q[3]};
+    }
+
+    // Rotation matrix of a unit quaternion (w, x, y, z)
+    std::array<double, 9> ToRotation(const Quaternion& q)
+    {
+        const auto [w, x, y, z] = q;
+        return {1 - 2 * (y * y + z * z),
+                2 * (x * y - w * z),
+                2 * (x * z + w * y),
+                2 * (x * y + w * z),
+                1 - 2 * (x * x + z * z),
+                2 * (y * z - w * x),
+                2 * (x * z - w * y),
+                2 * (y * z + w * x),
+                1 - 2 * (x * x + y * y)};
+    }
+
+    void Accumulate(openvr::ExtrapolationError& error,
+                    const double position,
+                    const double orientation)
+    {
+        if (error.samples == 0) {
+            error.position = position;
+            error.orientation = orientation;
+        }
+        else {
+            error.position += ErrorSmoothing * (position - error.position);
+            error.orientation +=
+                ErrorSmoothing * (orientation - error.orientation);
+        }
+        error.maxPosition = std::max(error.maxPosition, position);
+        error.maxOrientation = std::max(error.maxOrientation, orientation);
+        error.samples++;
+    }
+} // namespace
+
+// ===================
+// PoseUpsampler::Impl
+// ===================
+
+class openvr::PoseUpsampler::Impl
+{
+public:
+    UpsamplingOptions options;
+
+    struct Device
+    {
+        double timestamp = 0.0;
+        Pose sample;
+        // Offset from the extrapolation of the sample to the pose generated
+        // when it arrived, decaying to zero over the correction time
+        Vector positionCorrection = {};
+        Quaternion rotationCorrection = {1.0, 0.0, 0.0, 0.0};
+    };
+
+    using TrackedDeviceSerialNumber = std::string;
+    std::unordered_map<TrackedDeviceSerialNumber, Device> devices;
+    ExtrapolationError error;
+
+    mutable std::mutex mutex;
+
+    Pose extrapolate(const Device& device,
+                     const double timestamp,
+                     const bool corrected) const
+    {
+        const double elapsed = timestamp - device.timestamp;
+        const double dt = std::clamp(elapsed, 0.0, options.maxExtrapolation);
+
+        Pose pose = device.sample;
+        const auto& v = pose.linearVelocity;
+        const auto& w = pose.angularVelocity;
+
+        for (size_t i = 0; i < 3; ++i) {
+            pose.position[i] += v[i] * dt;
+        }
+
+        // The angular velocity is in the tracking space, the increment is
+        // applied on the left
+        Quaternion q = Multiply(
+            FromRotationVector({w[0] * dt, w[1] * dt, w[2] * dt}),
+            pose.quaternion);
+
+        const double weight =
+            corrected && options.correctionTime > 0.0
+                ? std::max(0.0, 1.0 - elapsed / options.correctionTime)
+                : 0.0;
+        if (weight > 0.0) {
+            for (size_t i = 0; i < 3; ++i) {
+                pose.position[i] += weight * device.positionCorrection[i];
+            }
+            q = Multiply(Scale(device.rotationCorrection, weight), q);
+        }
+
+        Normalize(q);
+        pose.quaternion = q;
+        pose.rotationRowMajor = ToRotation(q);
+        return pose;
+    }
+};
+
+// =============
+// PoseUpsampler
+// =============
+
+openvr::PoseUpsampler::PoseUpsampler(const UpsamplingOptions& options)
+    : pImpl{std::make_unique<Impl>()}
+{
+    pImpl->options = options;
+    pImpl->options.maxExtrapolation = std::max(0.0, options.maxExtrapolation);
+}
+
+openvr::PoseUpsampler::~PoseUpsampler() = default;
+
+bool openvr::PoseUpsampler::push(const std::string& serialNumber,
+                                 const double timestamp,
+                                 const Pose& pose)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    auto [it, inserted] = pImpl->devices.try_emplace(serialNumber);
+    Impl::Device& device = it->second;
+
+    if (!inserted) {
+        if (timestamp <= device.timestamp
+            || (pose.position == device.sample.position
+                && pose.quaternion == device.sample.quaternion)) {
+            return false;
+        }
+    }
+
+    // After a gap longer than the extrapolation, e.g. while the device was
+    // not tracked, the new sample is taken as it is
+    const double gap = timestamp - device.timestamp;
+    if (inserted || gap > pImpl->options.maxExtrapolation) {
+        device.positionCorrection = {};
+        device.rotationCorrection = {1.0, 0.0, 0.0, 0.0};
+    }
+    else {
+        // Error of the plain extrapolation of the previous sample
+        const Pose predicted = pImpl->extrapolate(device, timestamp, false);
+        double position = 0.0;
+        for (size_t i = 0; i < 3; ++i) {
+            const double d = predicted.position[i] - pose.position[i];
+            position += d * d;
+        }
+        position = std::sqrt(position);
+        const double orientation = Angle(
+            Multiply(predicted.quaternion, Conjugate(pose.quaternion)));
+
+        Accumulate(pImpl->error, position, orientation);
+
+        // Start from the pose generated so far, to avoid a step
+        const Pose current = pImpl->extrapolate(device, timestamp, true);
+        for (size_t i = 0; i < 3; ++i) {
+            device.positionCorrection[i] =
+                current.position[i] - pose.position[i];
+        }
+        device.rotationCorrection =
+            Multiply(current.quaternion, Conjugate(pose.quaternion));
+    }
+
+    device.timestamp = timestamp;
+    device.sample = pose;
+    return true;
+}
+
+void openvr::PoseUpsampler::remove(const std::string& serialNumber)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->devices.erase(serialNumber);
+}
+
+std::optional<openvr::Pose>
+openvr::PoseUpsampler::sample(const std::string& serialNumber,
+                              const double timestamp) const
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+
+    const auto it = pImpl->devices.find(serialNumber);
+    if (it == pImpl->devices.end()) {
+        return std::nullopt;
+    }
+
+    return pImpl->extrapolate(it->second, timestamp, true);
+}
+
+openvr::ExtrapolationError openvr::PoseUpsampler::error() const
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    return pImpl->error;
+}
+
+void openvr::PoseUpsampler::setCorrectionTime(const double correctionTime)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->options.correctionTime = correctionTime;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef OPENVR_TRACKERS_POSE_UPSAMPLER_H
+#define OPENVR_TRACKERS_POSE_UPSAMPLER_H
+
+#include "OpenVRTrackersDriver.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace openvr {
+    struct UpsamplingOptions;
+    struct ExtrapolationError;
+    class PoseUpsampler;
+} // namespace openvr
+
+struct openvr::UpsamplingOptions
+{
+    // Longest extrapolation from the latest sample, after which the pose is
+    // held, e.g. while the device is occluded
+    double maxExtrapolation = 0.05;
+    // Time over which the gap between the extrapolated pose and a new sample
+    // is closed, instead of jumping to the sample
+    double correctionTime = 0.01;
+};
+
+// Difference between the extrapolated pose and the new samples, at their
+// arrival. The smoothed values are exponential averages over the samples.
+struct openvr::ExtrapolationError
+{
+    size_t samples = 0;
+    double position = 0.0;
+    double maxPosition = 0.0;
+    double orientation = 0.0;
+    double maxOrientation = 0.0;
+};
+
+// Thread-safe generator of poses at a higher rate than the samples of the
+// runtime. The poses between two samples are extrapolated from the latest
+// one with its linear and angular velocity, both in the tracking space, and
+// the correction applied when a new sample arrives decays linearly over the
+// correction time. Samples must be pushed with increasing timestamps. A
+// sample that arrives after more than the maximum extrapolation restarts
+// the device, without correction and without accounting for the error.
+class openvr::PoseUpsampler
+{
+public:
+    explicit PoseUpsampler(const UpsamplingOptions& options = {});
+    ~PoseUpsampler();
+
+    // The runtime repeats the latest pose of a device until it is updated,
+    // the samples equal to the previous one are ignored. It returns true if
+    // the sample is new.
+    bool push(const std::string& serialNumber,
+              const double timestamp,
+              const Pose& pose);
+    // To be called when the device loses the tracking
+    void remove(const std::string& serialNumber);
+
+    // Pose of the device at the given time, with the velocities of the
+    // latest sample
+    std::optional<Pose> sample(const std::string& serialNumber,
+                               const double timestamp) const;
+
+    // Over the samples of all the devices
+    ExtrapolationError error() const;
+
+    // Also applied to the corrections in progress, e.g. when the correction
+    // time follows the period of the samples and the period changes
+    void setCorrectionTime(const double correctionTime);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+#endif // OPENVR_TRACKERS_POSE_UPSAMPLER_H
@@ -0,0 +1,394 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "SimulatedRuntime.h"
+
+#include <array>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// =======================
+// SimulatedRuntime::Impl
+// =======================
+
+class openvr::SimulatedRuntime::Impl
+{
+public:
+    struct Device
+    {
+        bool connected = false;
+        std::string serialNumber;
+        vr::ETrackedDeviceClass deviceClass = vr::TrackedDeviceClass_Invalid;
+        vr::ETrackedControllerRole role = vr::TrackedControllerRole_Invalid;
+        size_t hapticPulses = 0;
+    };
+
+    std::array<Device, vr::k_unMaxTrackedDeviceCount> devices;
+    std::deque<vr::VREvent_t> events;
+
+    bool running = false;
+    bool embedTimestamps = false;
+    std::chrono::microseconds callLatency{0};
+    const std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+
+    mutable std::mutex mutex;
+
+    void pushEvent(const vr::EVREventType type,
+                   const vr::TrackedDeviceIndex_t index)
+    {
+        vr::VREvent_t event{};
+        event.eventType = type;
+        event.trackedDeviceIndex = index;
+        events.push_back(event);
+    }
+
+    // Emulate the round trip with the runtime server
+    void call() const
+    {
+        if (callLatency.count() > 0) {
+            std::this_thread::sleep_for(callLatency);
+        }
+    }
+};
+
+// ================
+// SimulatedRuntime
+// ================
+
+openvr::SimulatedRuntime::SimulatedRuntime()
+    : pImpl{std::make_unique<Impl>()}
+{
+}
+
+openvr::SimulatedRuntime::~SimulatedRuntime() = default;
+
+bool openvr::SimulatedRuntime::connectDevice(
+    const vr::TrackedDeviceIndex_t index,
+    const std::string& serialNumber,
+    const vr::ETrackedDeviceClass deviceClass)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+
+    if (index >= vr::k_unMaxTrackedDeviceCount
+        || pImpl->devices[index].connected) {
+        return false;
+    }
+
+    pImpl->devices[index] = {true, serialNumber, deviceClass};
+    pImpl->pushEvent(vr::VREvent_TrackedDeviceActivated, index);
+    return true;
+}
+
+bool openvr::SimulatedRuntime::disconnectDevice(
+    const vr::TrackedDeviceIndex_t index)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+
+    if (index >= vr::k_unMaxTrackedDeviceCount
+        || !pImpl->devices[index].connected) {
+        return false;
+    }
+
+    pImpl->devices[index].connected = false;
+    pImpl->pushEvent(vr::VREvent_TrackedDeviceDeactivated, index);
+    return true;
+}
+
+void openvr::SimulatedRuntime::quit()
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->pushEvent(vr::VREvent_Quit, vr::k_unTrackedDeviceIndexInvalid);
+}
+
+void openvr::SimulatedRuntime::setCallLatency(
+    const std::chrono::microseconds latency)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->callLatency = latency;
+}
+
+bool openvr::SimulatedRuntime::setControllerRole(
+    const vr::TrackedDeviceIndex_t index,
+    const vr::ETrackedControllerRole role)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+
+    if (index >= vr::k_unMaxTrackedDeviceCount
+        || !pImpl->devices[index].connected) {
+        return false;
+    }
+
+    pImpl->devices[index].role = role;
+    pImpl->pushEvent(vr::VREvent_TrackedDeviceRoleChanged, index);
+    return true;
+}
+
+size_t openvr::SimulatedRuntime::hapticPulses(
+    const vr::TrackedDeviceIndex_t index) const
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+
+    if (index >= vr::k_unMaxTrackedDeviceCount) {
+        return 0;
+    }
+    return pImpl->devices[index].hapticPulses;
+}
+
+void openvr::SimulatedRuntime::setTimestampEmbedding(const bool enable)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->embedTimestamps = enable;
+}
+
+double openvr::SimulatedRuntime::TimestampNow()
+{
+    const double now = std::chrono::duration<double>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+    return std::fmod(now, TimestampPeriod);
+}
+
+double openvr::SimulatedRuntime::TimestampAge(const double embeddedTimestamp)
+{
+    return std::fmod(TimestampNow() - embeddedTimestamp + TimestampPeriod,
+                     TimestampPeriod);
+}
+
+bool openvr::SimulatedRuntime::initialize(std::string& /*error*/)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->running = true;
+    return true;
+}
+
+void openvr::SimulatedRuntime::shutdown()
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->running = false;
+}
+
+bool openvr::SimulatedRuntime::running() const
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    return pImpl->running;
+}
+
+bool openvr::SimulatedRuntime::isTrackedDeviceConnected(
+    const vr::TrackedDeviceIndex_t index)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->call();
+    return index < vr::k_unMaxTrackedDeviceCount
+           && pImpl->devices[index].connected;
+}
+
+vr::ETrackedDeviceClass openvr::SimulatedRuntime::trackedDeviceClass(
+    const vr::TrackedDeviceIndex_t index)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->call();
+
+    if (index >= vr::k_unMaxTrackedDeviceCount
+        || !pImpl->devices[index].connected) {
+        return vr::TrackedDeviceClass_Invalid;
+    }
+
+    return pImpl->devices[index].deviceClass;
+}
+
+std::string openvr::SimulatedRuntime::stringProperty(
+    const vr::TrackedDeviceIndex_t index,
+    const vr::ETrackedDeviceProperty property)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->call();
+
+    if (index >= vr::k_unMaxTrackedDeviceCount) {
+        return {};
+    }
+
+    switch (property) {
+        case vr::Prop_SerialNumber_String:
+            return pImpl->devices[index].serialNumber;
+        case vr::Prop_TrackingSystemName_String:
+            return "simulated";
+        default:
+            return {};
+    }
+}
+
+void openvr::SimulatedRuntime::deviceToAbsoluteTrackingPose(
+    const vr::ETrackingUniverseOrigin /*origin*/,
+    const float predictedSecondsFromNow,
+    vr::TrackedDevicePose_t* poses,
+    const uint32_t count)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->call();
+
+    const double time =
+        std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                      - pImpl->start)
+            .count()
+        + predictedSecondsFromNow;
+
+    for (uint32_t i = 0; i < count && i < vr::k_unMaxTrackedDeviceCount;
+         ++i) {
+        vr::TrackedDevicePose_t& pose = poses[i];
+        pose = {};
+        pose.bDeviceIsConnected = pImpl->devices[i].connected;
+        pose.bPoseIsValid = pImpl->devices[i].connected;
+        pose.eTrackingResult = pImpl->devices[i].connected
+                                   ? vr::TrackingResult_Running_OK
+                                   : vr::TrackingResult_Uninitialized;
+
+        if (!pImpl->devices[i].connected) {
+            continue;
+        }
+
+        // Each device rotates around the vertical axis of the tracking
+        // space (y) along a circle, with a phase that depends on its index
+        constexpr double Radius = 1.0;
+        constexpr double AngularVelocity = 1.0;
+        const double angle = AngularVelocity * time + 0.1 * i;
+        const float c = static_cast<float>(std::cos(angle));
+        const float s = static_cast<float>(std::sin(angle));
+
+        pose.mDeviceToAbsoluteTracking = {{
+            {c, 0, s, static_cast<float>(Radius) * c},
+            {0, 1, 0, 1.0f},
+            {-s, 0, c, -static_cast<float>(Radius) * s},
+        }};
+        pose.vVelocity = {{-static_cast<float>(Radius * AngularVelocity) * s,
+                           0,
+                           -static_cast<float>(Radius * AngularVelocity) * c}};
+        pose.vAngularVelocity = {{0, static_cast<float>(AngularVelocity), 0}};
+
+        if (pImpl->embedTimestamps) {
+            pose.mDeviceToAbsoluteTracking.m[0][3] =
+                static_cast<float>(TimestampNow());
+            pose.vVelocity.v[0] = 0;
+        }
+    }
+}
+
+bool openvr::SimulatedRuntime::pollNextEvent(vr::VREvent_t& event)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->call();
+
+    if (pImpl->events.empty()) {
+        return false;
+    }
+
+    event = pImpl->events.front();
+    pImpl->events.pop_front();
+    return true;
+}
+
+void openvr::SimulatedRuntime::acknowledgeQuit() {}
+
+void openvr::SimulatedRuntime::resetZeroPose(
+    const vr::ETrackingUniverseOrigin /*origin*/)
+{
+}
+
+bool openvr::SimulatedRuntime::playAreaRect(vr::HmdQuad_t& rect)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->call();
+
+    // A square smaller than the circle followed by the devices, so that
+    // they periodically leave the play area
+    constexpr float HalfSize = 0.8f;
+    rect.vCorners[0] = {{-HalfSize, 0, -HalfSize}};
+    rect.vCorners[1] = {{HalfSize, 0, -HalfSize}};
+    rect.vCorners[2] = {{HalfSize, 0, HalfSize}};
+    rect.vCorners[3] = {{-HalfSize, 0, HalfSize}};
+    return true;
+}
+
+vr::ETrackedControllerRole
+openvr::SimulatedRuntime::controllerRole(const vr::TrackedDeviceIndex_t index)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->call();
+
+    if (index >= vr::k_unMaxTrackedDeviceCount
+        || !pImpl->devices[index].connected) {
+        return vr::TrackedControllerRole_Invalid;
+    }
+    return pImpl->devices[index].role;
+}
+
+void openvr::SimulatedRuntime::triggerHapticPulse(
+    const vr::TrackedDeviceIndex_t index,
+    const uint32_t /*axis*/,
+    const unsigned short /*durationUs*/)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->call();
+
+    if (index < vr::k_unMaxTrackedDeviceCount
+        && pImpl->devices[index].connected) {
+        pImpl->devices[index].hapticPulses++;
+    }
+}
+
+bool openvr::SimulatedRuntime::enableSkeletalInput(std::string& /*error*/)
+{
+    return true;
+}
+
+bool openvr::SimulatedRuntime::updateSkeletalInput()
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->call();
+    return pImpl->running;
+}
+
+bool openvr::SimulatedRuntime::skeletalSummary(
+    const vr::ETrackedControllerRole hand,
+    vr::TrackedDeviceIndex_t& index,
+    vr::VRSkeletalSummaryData_t& summary,
+    vr::EVRSkeletalTrackingLevel& level)
+{
+    const auto lock = std::unique_lock(pImpl->mutex);
+    pImpl->call();
+
+    for (index = 0; index < vr::k_unMaxTrackedDeviceCount; ++index) {
+        if (pImpl->devices[index].connected
+            && pImpl->devices[index].role == hand) {
+            break;
+        }
+    }
+    if (index == vr::k_unMaxTrackedDeviceCount) {
+        return false;
+    }
+
+    const double time = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - pImpl->start)
+                            .count();
+
+    // Each finger closes with a delay with respect to the previous one
+    for (int finger = 0; finger < vr::VRFinger_Count; ++finger) {
+        summary.flFingerCurl[finger] =
+            static_cast<float>(0.5 - 0.5 * std::cos(time - 0.2 * finger));
+    }
+    for (int gap = 0; gap < vr::VRFingerSplay_Count; ++gap) {
+        summary.flFingerSplay[gap] =
+            static_cast<float>(0.5 - 0.5 * summary.flFingerCurl[gap + 1]);
+    }
+    level = vr::VRSkeletalTracking_Full;
+    return true;
+}
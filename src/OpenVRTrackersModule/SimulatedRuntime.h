@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef OPENVR_TRACKERS_SIMULATED_RUNTIME_H
+#define OPENVR_TRACKERS_SIMULATED_RUNTIME_H
+
+#include "OpenVRTrackersRuntime.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace openvr {
+    class SimulatedRuntime;
+} // namespace openvr
+
+// Runtime that does not require SteamVR. Devices are connected and
+// disconnected programmatically, and move along circles around the origin.
+// All the methods are thread-safe.
+class openvr::SimulatedRuntime final : public openvr::Runtime
+{
+public:
+    SimulatedRuntime();
+    ~SimulatedRuntime() override;
+
+    // Simulation control
+    bool connectDevice(const vr::TrackedDeviceIndex_t index,
+                       const std::string& serialNumber,
+                       const vr::ETrackedDeviceClass deviceClass =
+                           vr::TrackedDeviceClass_GenericTracker);
+    bool disconnectDevice(const vr::TrackedDeviceIndex_t index);
+    void quit();
+
+    // Time spent in every call, emulating the IPC with the runtime server
+    void setCallLatency(const std::chrono::microseconds latency);
+
+    // Role of a connected controller, TrackedControllerRole_Invalid by
+    // default
+    bool setControllerRole(const vr::TrackedDeviceIndex_t index,
+                           const vr::ETrackedControllerRole role);
+
+    // Number of haptic pulses triggered on a device since it was connected
+    size_t hapticPulses(const vr::TrackedDeviceIndex_t index) const;
+
+    // When enabled, the x coordinate of the position of all the devices
+    // carries the time at which the pose was computed, in seconds modulo
+    // TimestampPeriod. The time is read from the system clock, so that the
+    // age of a pose can be measured by any process on the same machine.
+    void setTimestampEmbedding(const bool enable);
+    static constexpr double TimestampPeriod = 10.0;
+    static double TimestampNow();
+    static double TimestampAge(const double embeddedTimestamp);
+
+    // Runtime
+    bool initialize(std::string& error) override;
+    void shutdown() override;
+    bool running() const override;
+
+    bool isTrackedDeviceConnected(const vr::TrackedDeviceIndex_t index) override;
+    vr::ETrackedDeviceClass
+    trackedDeviceClass(const vr::TrackedDeviceIndex_t index) override;
+    std::string
+    stringProperty(const vr::TrackedDeviceIndex_t index,
+                   const vr::ETrackedDeviceProperty property) override;
+
+    void deviceToAbsoluteTrackingPose(const vr::ETrackingUniverseOrigin origin,
+                                      const float predictedSecondsFromNow,
+                                      vr::TrackedDevicePose_t* poses,
+                                      const uint32_t count) override;
+
+    bool pollNextEvent(vr::VREvent_t& event) override;
+    void acknowledgeQuit() override;
+
+    void resetZeroPose(const vr::ETrackingUniverseOrigin origin) override;
+
+    bool playAreaRect(vr::HmdQuad_t& rect) override;
+
+    vr::ETrackedControllerRole
+    controllerRole(const vr::TrackedDeviceIndex_t index) override;
+    void triggerHapticPulse(const vr::TrackedDeviceIndex_t index,
+                            const uint32_t axis,
+                            const unsigned short durationUs) override;
+
+    // The hands are the controllers with the LeftHand and RightHand roles,
+    // whose fingers open and close periodically
+    bool enableSkeletalInput(std::string& error) override;
+    bool updateSkeletalInput() override;
+    bool skeletalSummary(const vr::ETrackedControllerRole hand,
+                         vr::TrackedDeviceIndex_t& index,
+                         vr::VRSkeletalSummaryData_t& summary,
+                         vr::EVRSkeletalTrackingLevel& level) override;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+#endif // OPENVR_TRACKERS_SIMULATED_RUNTIME_H
@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#include "WorkspaceMonitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace {
+    using Vector = std::array<double, 3>;
+
+    double Dot(const Vector& a, const Vector& b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    Vector Cross(const Vector& a, const Vector& b)
+    {
+        return {a[1] * b[2] - a[2] * b[1],
+                a[2] * b[0] - a[0] * b[2],
+                a[0] * b[1] - a[1] * b[0]};
+    }
+
+    // State of a device with respect to a volume
+    enum class Side : int8_t
+    {
+        Unknown,
+        Inside,
+        Outside,
+    };
+} // namespace
+
+// ===============
+// WorkspaceVolume
+// ===============
+
+openvr::WorkspaceVolume
+openvr::WorkspaceVolume::Box(const std::string& name,
+                             const std::array<double, 3>& min,
+                             const std::array<double, 3>& max)
+{
+    WorkspaceVolume volume;
+    volume.name = name;
+
+    for (size_t axis = 0; axis < 3; ++axis) {
+        std::array<double, 4> upper = {0.0, 0.0, 0.0, max[axis]};
+        std::array<double, 4> lower = {0.0, 0.0, 0.0, -min[axis]};
+        upper[axis] = 1.0;
+        lower[axis] = -1.0;
+        volume.planes.push_back(upper);
+        volume.planes.push_back(lower);
+    }
+
+    return volume;
+}
+
+std::optional<openvr::WorkspaceVolume> openvr::WorkspaceVolume::HalfSpaces(
+    const std::string& name,
+    const std::vector<std::array<double, 4>>& planes)
+{
+    WorkspaceVolume volume;
+    volume.name = name;
+
+    for (const auto& plane : planes) {
+        const double norm = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1]
+                                      + plane[2] * plane[2]);
+        if (!(norm > 0.0)) {
+            return std::nullopt;
+        }
+        volume.planes.push_back({plane[0] / norm,
+                                 plane[1] / norm,
+                                 plane[2] / norm,
+                                 plane[3] / norm});
+    }
+
+    return volume;
+}
+
+openvr::WorkspaceVolume
+openvr::WorkspaceVolume::PlayAreaPrism(const std::string& name,
+                                       const PlayArea& area,
+                                       const double height)
+{
+    WorkspaceVolume volume;
+    volume.name = name;
+
+    const auto& corners = area.corners;
+    const Vector& up = area.up;
+
+    Vector center = {0.0, 0.0, 0.0};
+    for (const auto& corner : corners) {
+        for (size_t i = 0; i < 3; ++i) {
+            center[i] += corner[i] / corners.size();
+        }
+    }
+
+    // Vertical walls through the edges, whatever the winding of the corners
+    for (size_t i = 0; i < corners.size(); ++i) {
+        const Vector& a = corners[i];
+        const Vector& b = corners[(i + 1) % corners.size()];
+
+        Vector normal = Cross({b[0] - a[0], b[1] - a[1], b[2] - a[2]}, up);
+        const double norm = std::sqrt(Dot(normal, normal));
+        if (!(norm > 0.0)) {
+            continue;
+        }
+
+        double sign = 1.0 / norm;
+        if (Dot(normal, {center[0] - a[0], center[1] - a[1], center[2] - a[2]})
+            > 0.0) {
+            sign = -sign;
+        }
+        for (auto& element : normal) {
+            element *= sign;
+        }
+
+        volume.planes.push_back(
+            {normal[0], normal[1], normal[2], Dot(normal, a)});
+    }
+
+    // Floor and ceiling
+    const double floor = Dot(up, corners[0]);
+    volume.planes.push_back({-up[0], -up[1], -up[2], -floor});
+    volume.planes.push_back({up[0], up[1], up[2], floor + height});
+
+    return volume;
+}
+
+// ======================
+// WorkspaceMonitor::Impl
+// ======================
+
+class openvr::WorkspaceMonitor::Impl
+{
+public:
+    std::vector<WorkspaceVolume> volumes;
+    double hysteresis;
+
+    using TrackedDeviceSerialNumber = std::string;
+    std::unordered_map<TrackedDeviceSerialNumber, std::vector<Side>> sides;
+
+    // Buffers of the batched evaluation, one element per device
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+    std::vector<double> distances;
+    std::vector<std::vector<Side>*> deviceSides;
+};
+
+// ================
+// WorkspaceMonitor
+// ================
+
+openvr::WorkspaceMonitor::WorkspaceMonitor(std::vector<WorkspaceVolume> volumes,
+                                           const double hysteresis)
+    : pImpl{std::make_unique<Impl>()}
+{
+    pImpl->volumes = std::move(volumes);
+    pImpl->hysteresis = hysteresis;
+}
+
+openvr::WorkspaceMonitor::~WorkspaceMonitor() = default;
+
+const std::vector<openvr::WorkspaceVolume>&
+openvr::WorkspaceMonitor::volumes() const
+{
+    return pImpl->volumes;
+}
+
+void openvr::WorkspaceMonitor::update(
+    const std::vector<std::string>& serialNumbers,
+    const std::vector<std::array<double, 3>>& positions,
+    const double timestamp,
+    std::vector<WorkspaceEvent>& events)
+{
+    const size_t count = std::min(serialNumbers.size(), positions.size());
+
+    // Structure of arrays, so that each plane is tested against all the
+    // devices in a loop that the compiler can vectorize
+    pImpl->x.resize(count);
+    pImpl->y.resize(count);
+    pImpl->z.resize(count);
+    pImpl->deviceSides.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        pImpl->x[i] = positions[i][0];
+        pImpl->y[i] = positions[i][1];
+        pImpl->z[i] = positions[i][2];
+
+        auto& sides = pImpl->sides[serialNumbers[i]];
+        sides.resize(pImpl->volumes.size(), Side::Unknown);
+        pImpl->deviceSides[i] = &sides;
+    }
+
+    const double* x = pImpl->x.data();
+    const double* y = pImpl->y.data();
+    const double* z = pImpl->z.data();
+
+    for (size_t v = 0; v < pImpl->volumes.size(); ++v) {
+        const WorkspaceVolume& volume = pImpl->volumes[v];
+
+        // The signed distance from a convex volume is the largest of the
+        // signed distances from its planes
+        pImpl->distances.assign(count,
+                                -std::numeric_limits<double>::infinity());
+        double* distances = pImpl->distances.data();
+
+        for (const auto& [nx, ny, nz, d] : volume.planes) {
+            for (size_t i = 0; i < count; ++i) {
+                distances[i] = std::max(distances[i],
+                                        nx * x[i] + ny * y[i] + nz * z[i] - d);
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            Side& side = (*pImpl->deviceSides[i])[v];
+            const double distance = distances[i];
+
+            Side next = side;
+            switch (side) {
+                case Side::Unknown:
+                    next = distance > 0.0 ? Side::Outside : Side::Inside;
+                    break;
+                case Side::Inside:
+                    next = distance > 0.0 ? Side::Outside : Side::Inside;
+                    break;
+                case Side::Outside:
+                    next = distance < -pImpl->hysteresis ? Side::Inside
+                                                         : Side::Outside;
+                    break;
+            }
+
+            const bool report =
+                next != side
+                && !(side == Side::Unknown && next == Side::Inside);
+            side = next;
+
+            if (report) {
+                events.push_back({serialNumbers[i],
+                                  volume.name,
+                                  next == Side::Inside,
+                                  distance,
+                                  timestamp});
+            }
+        }
+    }
+}
+
+void openvr::WorkspaceMonitor::reset(std::vector<WorkspaceVolume> volumes)
+{
+    pImpl->volumes = std::move(volumes);
+    pImpl->sides.clear();
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+#ifndef OPENVR_TRACKERS_WORKSPACE_MONITOR_H
+#define OPENVR_TRACKERS_WORKSPACE_MONITOR_H
+
+#include "OpenVRTrackersDriver.h"
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace openvr {
+    struct WorkspaceVolume;
+    struct WorkspaceEvent;
+    class WorkspaceMonitor;
+} // namespace openvr
+
+// Convex volume in which the devices are permitted, intersection of the
+// half-spaces n . p <= d. It is expressed in the frame of the poses.
+struct openvr::WorkspaceVolume
+{
+    std::string name;
+    // (nx, ny, nz, d), with unit normals pointing outside
+    std::vector<std::array<double, 4>> planes;
+
+    // Axis aligned box
+    static WorkspaceVolume Box(const std::string& name,
+                               const std::array<double, 3>& min,
+                               const std::array<double, 3>& max);
+
+    // Intersection of the given half-spaces, whose normals are normalized.
+    // It fails if a normal is null.
+    static std::optional<WorkspaceVolume>
+    HalfSpaces(const std::string& name,
+               const std::vector<std::array<double, 4>>& planes);
+
+    // Play area of the chaperone extruded from the floor up to height
+    static WorkspaceVolume PlayAreaPrism(const std::string& name,
+                                         const PlayArea& area,
+                                         const double height);
+};
+
+// Crossing of the boundary of a volume by a device
+struct openvr::WorkspaceEvent
+{
+    std::string serialNumber;
+    std::string volume;
+    bool inside;
+    // Distance of the device from the boundary, positive outside. Outside,
+    // it is a lower bound of the Euclidean distance from the volume.
+    double distance;
+    double timestamp;
+};
+
+// Evaluates the positions of all the devices of a snapshot against all the
+// volumes, reporting the devices that left or entered them. A device is
+// outside when it crosses the boundary, and back inside only when it is
+// hysteresis meters within it, to avoid bursts of events on the boundary.
+class openvr::WorkspaceMonitor
+{
+public:
+    WorkspaceMonitor(std::vector<WorkspaceVolume> volumes,
+                     const double hysteresis = 0.01);
+    ~WorkspaceMonitor();
+
+    const std::vector<WorkspaceVolume>& volumes() const;
+
+    // Evaluate a snapshot, appending the crossings to events. Devices seen
+    // for the first time are reported only if outside of a volume. Devices
+    // not in the snapshot keep their last state.
+    void update(const std::vector<std::string>& serialNumbers,
+                const std::vector<std::array<double, 3>>& positions,
+                const double timestamp,
+                std::vector<WorkspaceEvent>& events);
+
+    // Forget the state of all the devices, e.g. after a change of the frame
+    // of the poses
+    void reset(std::vector<WorkspaceVolume> volumes);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+};
+
+#endif // OPENVR_TRACKERS_WORKSPACE_MONITOR_H
@@ -0,0 +1,649 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+// Offline analysis of the transforms recorded with yarpdatadumper.
+//
+// The data files of the dumper contain one line per message received from
+// /transformServer/transforms:o:
+//
+//   <seq> <rx time> [<tx time>] (src dst timestamp tx ty tz qw qx qy qz) ...
+//
+// The files are memory mapped and split in chunks at line boundaries, that
+// are parsed in parallel. The transform server publishes all its transforms
+// in every message, therefore the samples of a frame with the same timestamp
+// of the previous one are repetitions and are discarded.
+//
+// For every frame it reports:
+//
+// - rate:     number of distinct samples per second
+// - jitter:   standard deviation of the intervals between the samples
+// - gaps:     intervals longer than gapFactor times the median interval
+// - outliers: samples implying a speed above maxSpeed from the previous one
+// - latency:  reception time minus the timestamp of the sample
+//
+// With --output, the distinct samples are also exported in columns, one
+// binary file of native values per column (uint32 for the frame, float for
+// the quaternion, double otherwise), grouped by frame in the order listed by
+// <output>.frames.txt.
+
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        std::vector<std::string> files;
+        size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        double gapFactor = 3.0;
+        double maxSpeed = 10.0;
+        std::string output;
+    };
+
+    struct Sample
+    {
+        double rxTime;
+        double timestamp;
+        std::array<double, 3> position;
+        std::array<float, 4> quaternion; // w, x, y, z
+    };
+
+    // Samples parsed from a chunk, with the frames numbered in the order in
+    // which they are found in the chunk
+    struct ChunkResult
+    {
+        std::unordered_map<std::string_view, size_t> frameIds;
+        std::vector<std::string_view> frames;
+        std::vector<std::vector<Sample>> samples;
+        size_t lines = 0;
+        size_t malformed = 0;
+    };
+
+    struct FrameStats
+    {
+        std::string name;
+        size_t samples = 0;
+        size_t repeated = 0;
+        size_t backwards = 0;
+        double first = 0.0;
+        double last = 0.0;
+        double rate = 0.0;
+        double medianInterval = 0.0;
+        double jitter = 0.0;
+        size_t gaps = 0;
+        double maxGap = 0.0;
+        size_t outliers = 0;
+        double maxSpeed = 0.0;
+        double latency50 = 0.0;
+        double latency99 = 0.0;
+    };
+
+    // Tokenizer of a line, that does not allocate
+    class LineParser
+    {
+    public:
+        LineParser(const char* begin, const char* end)
+            : m_p(begin)
+            , m_end(end)
+        {
+        }
+
+        void skipSpaces()
+        {
+            while (m_p < m_end
+                   && (*m_p == ' ' || *m_p == '\t' || *m_p == '\r')) {
+                ++m_p;
+            }
+        }
+
+        bool atEnd()
+        {
+            skipSpaces();
+            return m_p >= m_end;
+        }
+
+        bool peek(const char c)
+        {
+            skipSpaces();
+            return m_p < m_end && *m_p == c;
+        }
+
+        bool consume(const char c)
+        {
+            if (!peek(c)) {
+                return false;
+            }
+            ++m_p;
+            return true;
+        }
+
+        bool number(double& value)
+        {
+            skipSpaces();
+            const auto [ptr, error] = std::from_chars(m_p, m_end, value);
+            if (error != std::errc()) {
+                return false;
+            }
+            m_p = ptr;
+            return true;
+        }
+
+        // Bare or quoted string, as written by Bottle::toString()
+        bool string(std::string_view& value)
+        {
+            skipSpaces();
+            if (m_p >= m_end) {
+                return false;
+            }
+
+            if (*m_p == '"') {
+                const char* begin = ++m_p;
+                while (m_p < m_end && *m_p != '"') {
+                    m_p += (*m_p == '\\') ? 2 : 1;
+                }
+                if (m_p >= m_end) {
+                    return false;
+                }
+                value = std::string_view(begin, m_p - begin);
+                ++m_p;
+                return true;
+            }
+
+            const char* begin = m_p;
+            while (m_p < m_end && *m_p != ' ' && *m_p != '\t' && *m_p != ')'
+                   && *m_p != '(') {
+                ++m_p;
+            }
+            value = std::string_view(begin, m_p - begin);
+            return !value.empty();
+        }
+
+        // Skip the rest of a list whose opening parenthesis was consumed
+        void skipList()
+        {
+            int depth = 1;
+            while (m_p < m_end && depth > 0) {
+                depth += (*m_p == '(') - (*m_p == ')');
+                ++m_p;
+            }
+        }
+
+    private:
+        const char* m_p;
+        const char* m_end;
+    };
+
+    // Parse a line, appending its transforms to the result
+    bool ParseLine(const char* begin, const char* end, ChunkResult& result)
+    {
+        LineParser parser(begin, end);
+
+        // Sequence number and reception time, followed by the optional
+        // transmission time
+        double sequence;
+        double rxTime;
+        if (!(parser.number(sequence) && parser.number(rxTime))) {
+            return false;
+        }
+        double txTime;
+        if (!parser.peek('(')) {
+            parser.number(txTime);
+        }
+
+        while (parser.consume('(')) {
+            std::string_view src;
+            std::string_view dst;
+            std::array<double, 8> values;
+
+            bool valid = parser.string(src) && parser.string(dst);
+            for (size_t i = 0; valid && i < values.size(); ++i) {
+                valid = parser.number(values[i]);
+            }
+
+            if (!(valid && parser.consume(')'))) {
+                parser.skipList();
+                return false;
+            }
+
+            // The frames are identified by their child frame
+            auto [it, inserted] =
+                result.frameIds.try_emplace(dst, result.frames.size());
+            if (inserted) {
+                result.frames.push_back(dst);
+                result.samples.emplace_back();
+            }
+
+            result.samples[it->second].push_back(
+                {rxTime,
+                 values[0],
+                 {values[1], values[2], values[3]},
+                 {static_cast<float>(values[4]),
+                  static_cast<float>(values[5]),
+                  static_cast<float>(values[6]),
+                  static_cast<float>(values[7])}});
+        }
+
+        return parser.atEnd();
+    }
+
+    void ParseChunk(const char* begin, const char* end, ChunkResult& result)
+    {
+        while (begin < end) {
+            const char* lineEnd =
+                static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+            if (!lineEnd) {
+                lineEnd = end;
+            }
+
+            if (lineEnd > begin) {
+                result.lines++;
+                if (!ParseLine(begin, lineEnd, result)) {
+                    result.malformed++;
+                }
+            }
+            begin = lineEnd + 1;
+        }
+    }
+
+    // Split the file in chunks starting at the beginning of a line
+    std::vector<std::pair<const char*, const char*>>
+    SplitLines(const char* data, const size_t size, const size_t chunks)
+    {
+        std::vector<std::pair<const char*, const char*>> ranges;
+        const char* end = data + size;
+        const char* begin = data;
+
+        for (size_t i = 1; i <= chunks && begin < end; ++i) {
+            const char* split = i == chunks ? end : data + size * i / chunks;
+            if (split < begin) {
+                continue;
+            }
+            const char* newline =
+                static_cast<const char*>(std::memchr(split, '\n', end - split));
+            split = newline ? newline + 1 : end;
+
+            ranges.emplace_back(begin, split);
+            begin = split;
+        }
+
+        return ranges;
+    }
+
+    double Percentile(std::vector<double> values, const double p)
+    {
+        if (values.empty()) {
+            return 0.0;
+        }
+        const auto nth =
+            values.begin() + static_cast<long>(p * (values.size() - 1));
+        std::nth_element(values.begin(), nth, values.end());
+        return *nth;
+    }
+
+    // Drop the repeated samples and compute the statistics of a frame
+    FrameStats Analyze(const std::string& name,
+                       std::vector<Sample>& samples,
+                       const Options& options)
+    {
+        FrameStats stats;
+        stats.name = name;
+
+        const size_t received = samples.size();
+        samples.erase(std::unique(samples.begin(),
+                                  samples.end(),
+                                  [](const Sample& a, const Sample& b) {
+                                      return a.timestamp == b.timestamp;
+                                  }),
+                      samples.end());
+        stats.samples = samples.size();
+        stats.repeated = received - samples.size();
+
+        if (samples.empty()) {
+            return stats;
+        }
+
+        stats.first = samples.front().timestamp;
+        stats.last = samples.back().timestamp;
+
+        std::vector<double> intervals;
+        std::vector<double> latencies;
+        intervals.reserve(samples.size());
+        latencies.reserve(samples.size());
+
+        for (size_t i = 0; i < samples.size(); ++i) {
+            latencies.push_back(samples[i].rxTime - samples[i].timestamp);
+            if (i == 0) {
+                continue;
+            }
+
+            const double dt = samples[i].timestamp - samples[i - 1].timestamp;
+            if (dt <= 0.0) {
+                stats.backwards++;
+                continue;
+            }
+            intervals.push_back(dt);
+
+            const auto& p0 = samples[i - 1].position;
+            const auto& p1 = samples[i].position;
+            const double dx = p1[0] - p0[0];
+            const double dy = p1[1] - p0[1];
+            const double dz = p1[2] - p0[2];
+            const double distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+            const double speed = distance / dt;
+            stats.maxSpeed = std::max(stats.maxSpeed, speed);
+            if (speed > options.maxSpeed) {
+                stats.outliers++;
+            }
+        }
+
+        if (stats.last > stats.first) {
+            stats.rate = (samples.size() - 1) / (stats.last - stats.first);
+        }
+
+        if (!intervals.empty()) {
+            stats.medianInterval = Percentile(intervals, 0.5);
+
+            double sum = 0.0;
+            double squares = 0.0;
+            for (const double dt : intervals) {
+                sum += dt;
+                squares += dt * dt;
+                if (dt > options.gapFactor * stats.medianInterval) {
+                    stats.gaps++;
+                    stats.maxGap = std::max(stats.maxGap, dt);
+                }
+            }
+            const double mean = sum / intervals.size();
+            const double variance = squares / intervals.size() - mean * mean;
+            stats.jitter = std::sqrt(std::max(0.0, variance));
+        }
+
+        stats.latency50 = Percentile(latencies, 0.5);
+        stats.latency99 = Percentile(latencies, 0.99);
+
+        return stats;
+    }
+
+    template <typename T, typename Getter>
+    bool WriteColumn(const std::string& path,
+                     const std::vector<std::vector<Sample>>& frames,
+                     Getter get)
+    {
+        std::ofstream file(path, std::ios::binary);
+        std::vector<T> column;
+
+        for (size_t f = 0; f < frames.size(); ++f) {
+            column.clear();
+            for (const auto& sample : frames[f]) {
+                column.push_back(static_cast<T>(get(f, sample)));
+            }
+            file.write(reinterpret_cast<const char*>(column.data()),
+                       static_cast<std::streamsize>(column.size() * sizeof(T)));
+        }
+
+        return static_cast<bool>(file);
+    }
+
+    bool Export(const std::string& prefix,
+                const std::vector<FrameStats>& stats,
+                const std::vector<std::vector<Sample>>& frames)
+    {
+        std::ofstream index(prefix + ".frames.txt");
+        index << "# index first count name" << std::endl;
+        size_t first = 0;
+        for (size_t f = 0; f < frames.size(); ++f) {
+            index << f << " " << first << " " << frames[f].size() << " "
+                  << stats[f].name << std::endl;
+            first += frames[f].size();
+        }
+
+        using S = const Sample&;
+        const auto quaternion = [](const size_t i) {
+            return [i](size_t, S s) { return s.quaternion[i]; };
+        };
+
+        return static_cast<bool>(index)
+               && WriteColumn<uint32_t>(prefix + ".frame.bin",
+                                        frames,
+                                        [](size_t f, S) { return f; })
+               && WriteColumn<double>(prefix + ".rxTime.bin",
+                                      frames,
+                                      [](size_t, S s) { return s.rxTime; })
+               && WriteColumn<double>(prefix + ".timestamp.bin",
+                                      frames,
+                                      [](size_t, S s) { return s.timestamp; })
+               && WriteColumn<double>(prefix + ".x.bin",
+                                      frames,
+                                      [](size_t, S s) { return s.position[0]; })
+               && WriteColumn<double>(prefix + ".y.bin",
+                                      frames,
+                                      [](size_t, S s) { return s.position[1]; })
+               && WriteColumn<double>(prefix + ".z.bin",
+                                      frames,
+                                      [](size_t, S s) { return s.position[2]; })
+               && WriteColumn<float>(
+                   prefix + ".qw.bin", frames, quaternion(0))
+               && WriteColumn<float>(
+                   prefix + ".qx.bin", frames, quaternion(1))
+               && WriteColumn<float>(
+                   prefix + ".qy.bin", frames, quaternion(2))
+               && WriteColumn<float>(
+                   prefix + ".qz.bin", frames, quaternion(3));
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) {
+                options.files.push_back(arg);
+                continue;
+            }
+
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+
+            if (arg == "--output") {
+                options.output = argv[++i];
+                continue;
+            }
+
+            const double value = std::atof(argv[++i]);
+
+            if (arg == "--threads") {
+                options.threads = static_cast<size_t>(value);
+            }
+            else if (arg == "--gapFactor") {
+                options.gapFactor = value;
+            }
+            else if (arg == "--maxSpeed") {
+                options.maxSpeed = value;
+            }
+            else {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+
+        return !options.files.empty() && options.threads > 0
+               && options.gapFactor > 1.0 && options.maxSpeed > 0.0;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::cerr << "Usage: dump_analyzer [--threads n] [--gapFactor k] "
+                  << "[--maxSpeed m/s] [--output prefix] data.log..."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto start = Clock::now();
+
+    // The files are kept mapped until the end, the frame names point
+    // into them
+    std::vector<std::unique_ptr<openvr_common::MappedFile>> files;
+    std::vector<ChunkResult> chunks;
+    size_t bytes = 0;
+
+    for (const auto& path : options.files) {
+        auto file = std::make_unique<openvr_common::MappedFile>();
+        if (!file->open(path)) {
+            std::cerr << file->error() << std::endl;
+            return EXIT_FAILURE;
+        }
+        bytes += file->size();
+
+        const auto ranges =
+            SplitLines(reinterpret_cast<const char*>(file->data()),
+                       file->size(),
+                       options.threads);
+        const size_t offset = chunks.size();
+        chunks.resize(offset + ranges.size());
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            workers.emplace_back([&, i] {
+                ParseChunk(
+                    ranges[i].first, ranges[i].second, chunks[offset + i]);
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        files.push_back(std::move(file));
+    }
+
+    const auto parsed = Clock::now();
+
+    // Merge the chunks in file order, so that the samples of every frame
+    // stay in the order in which they were received
+    std::unordered_map<std::string_view, size_t> frameIds;
+    std::vector<std::string> names;
+    std::vector<std::vector<Sample>> frames;
+    size_t lines = 0;
+    size_t malformed = 0;
+
+    for (auto& chunk : chunks) {
+        lines += chunk.lines;
+        malformed += chunk.malformed;
+
+        for (size_t i = 0; i < chunk.frames.size(); ++i) {
+            auto [it, inserted] =
+                frameIds.try_emplace(chunk.frames[i], frames.size());
+            if (inserted) {
+                names.emplace_back(chunk.frames[i]);
+                frames.emplace_back(std::move(chunk.samples[i]));
+                continue;
+            }
+            auto& samples = frames[it->second];
+            samples.insert(samples.end(),
+                           chunk.samples[i].begin(),
+                           chunk.samples[i].end());
+        }
+        chunk = {};
+    }
+
+    // The frames are analyzed in parallel as well
+    std::vector<FrameStats> stats(frames.size());
+    std::atomic<size_t> nextFrame{0};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < std::min(options.threads, frames.size()); ++t) {
+        workers.emplace_back([&] {
+            for (size_t f = nextFrame++; f < frames.size(); f = nextFrame++) {
+                stats[f] = Analyze(names[f], frames[f], options);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    const auto analyzed = Clock::now();
+
+    // Report
+    std::cout << std::fixed << std::setprecision(3) << std::left
+              << std::setw(32) << "frame" << std::right << std::setw(10)
+              << "samples" << std::setw(10) << "rate" << std::setw(10)
+              << "jitter" << std::setw(8) << "gaps" << std::setw(10)
+              << "maxGap" << std::setw(10) << "outliers" << std::setw(10)
+              << "maxSpeed" << std::setw(10) << "lat50" << std::setw(10)
+              << "lat99" << std::endl
+              << std::left << std::setw(32) << "" << std::right
+              << std::setw(10) << "" << std::setw(10) << "Hz" << std::setw(10)
+              << "ms" << std::setw(8) << "" << std::setw(10) << "ms"
+              << std::setw(10) << "" << std::setw(10) << "m/s" << std::setw(10)
+              << "ms" << std::setw(10) << "ms" << std::endl;
+
+    for (const auto& frame : stats) {
+        std::cout << std::left << std::setw(32) << frame.name << std::right
+                  << std::setw(10) << frame.samples << std::setw(10)
+                  << frame.rate << std::setw(10) << 1e3 * frame.jitter
+                  << std::setw(8) << frame.gaps << std::setw(10)
+                  << 1e3 * frame.maxGap << std::setw(10) << frame.outliers
+                  << std::setw(10) << frame.maxSpeed << std::setw(10)
+                  << 1e3 * frame.latency50 << std::setw(10)
+                  << 1e3 * frame.latency99 << std::endl;
+
+        if (frame.backwards > 0) {
+            std::cout << "  " << frame.backwards
+                      << " samples with a timestamp older than the previous one"
+                      << std::endl;
+        }
+    }
+
+    const double parseTime =
+        std::chrono::duration<double>(parsed - start).count();
+    const double totalTime =
+        std::chrono::duration<double>(analyzed - start).count();
+
+    std::cout << std::endl
+              << lines << " lines (" << malformed << " malformed), "
+              << 1e-6 * bytes << " MB parsed in " << parseTime << " s ("
+              << (parseTime > 0.0 ? 1e-6 * bytes / parseTime : 0.0)
+              << " MB/s) with " << options.threads << " threads, "
+              << totalTime << " s in total" << std::endl;
+
+    if (!options.output.empty()) {
+        if (!Export(options.output, stats, frames)) {
+            std::cerr << "Failed to write the output " << options.output
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "Samples exported to " << options.output << ".*"
+                  << std::endl;
+    }
+
+    return malformed < lines ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+// End-to-end latency benchmark of yarp-openvr-trackers.
+//
+// The module, a transformServer and a probe consumer run in this process
+// on a process-local YARP network, so no yarpserver is needed. The module
+// uses a simulated runtime that embeds the sampling time in the x
+// coordinate of every pose, and the probe measures the age of each new
+// sample when it is received. The measurement is repeated for all the
+// combinations of device counts, module periods and probe modes:
+//
+// - stream: the probe reads the transforms:o port of the transformServer
+// - poll:   the probe calls getTransform on a frameTransformClient
+
+#include "OpenVRTrackersModule.h"
+#include "SimulatedRuntime.h"
+
+#include <yarp/dev/IFrameTransform.h>
+#include <yarp/dev/PolyDriver.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Network.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/ResourceFinder.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Matrix.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace latency_benchmark {
+    const std::string Prefix = "/latencyBenchmark";
+    const std::string BaseFrame = "openVR_origin";
+    const std::string FramePrefix = "/trackers/SIM-";
+    constexpr double Warmup = 1.0;
+
+    // Ages of the received samples, in milliseconds
+    class Probe
+    {
+    public:
+        void record(const std::string& frame, const double embeddedTimestamp)
+        {
+            const auto lock = std::unique_lock(m_mutex);
+
+            // The transformServer republishes the last sample of each frame,
+            // only the first reception of a new sample is measured
+            auto& last = m_lastTimestamps[frame];
+            if (last == embeddedTimestamp) {
+                return;
+            }
+            last = embeddedTimestamp;
+
+            if (m_recording) {
+                m_ages.push_back(
+                    1e3
+                    * openvr::SimulatedRuntime::TimestampAge(embeddedTimestamp));
+            }
+        }
+
+        void startRecording()
+        {
+            const auto lock = std::unique_lock(m_mutex);
+            m_recording = true;
+        }
+
+        std::vector<double> ages()
+        {
+            const auto lock = std::unique_lock(m_mutex);
+            m_recording = false;
+            return m_ages;
+        }
+
+    private:
+        bool m_recording = false;
+        std::vector<double> m_ages;
+        std::unordered_map<std::string, double> m_lastTimestamps;
+        std::mutex m_mutex;
+    };
+
+    class StreamProbe : public yarp::os::TypedReaderCallback<yarp::os::Bottle>
+    {
+    public:
+        explicit StreamProbe(Probe& probe)
+            : m_probe(probe)
+        {
+        }
+
+        // Every element is a list (src dst timestamp tx ty tz qw qx qy qz)
+        void onRead(yarp::os::Bottle& transforms) override
+        {
+            for (size_t i = 0; i < transforms.size(); ++i) {
+                const yarp::os::Bottle* transform = transforms.get(i).asList();
+                if (!transform || transform->size() < 6) {
+                    continue;
+                }
+
+                const std::string frame = transform->get(1).asString();
+                if (frame.rfind(FramePrefix, 0) == 0) {
+                    m_probe.record(frame, transform->get(3).asFloat64());
+                }
+            }
+        }
+
+    private:
+        Probe& m_probe;
+    };
+
+    // Stops the module running in its thread when leaving the scope, also
+    // if the benchmark fails
+    struct ModuleStopper
+    {
+        OpenVRTrackersModule& module;
+
+        ~ModuleStopper()
+        {
+            module.stopModule();
+            module.joinModule();
+        }
+    };
+
+    struct Result
+    {
+        size_t devices;
+        double period;
+        std::string mode;
+        std::vector<double> ages;
+    };
+
+    double Percentile(std::vector<double> samples, const double p)
+    {
+        if (samples.empty()) {
+            return 0.0;
+        }
+        const auto nth =
+            samples.begin() + static_cast<long>(p * (samples.size() - 1));
+        std::nth_element(samples.begin(), nth, samples.end());
+        return *nth;
+    }
+
+    // Read an option that can be a single value or a list of values
+    yarp::os::Bottle ListOption(const yarp::os::Searchable& config,
+                                const std::string& key,
+                                const std::string& defaultValues)
+    {
+        yarp::os::Bottle list(defaultValues);
+
+        if (config.check(key)) {
+            const yarp::os::Value& value = config.find(key);
+            list = value.isList() ? *value.asList()
+                                  : yarp::os::Bottle(value.toString());
+        }
+
+        return list;
+    }
+
+    bool Run(const size_t devices,
+             const double period,
+             const std::string& mode,
+             const double duration,
+             Result& result)
+    {
+        result = {devices, period, mode, {}};
+
+        // Start the module with the simulated runtime
+        std::vector<std::string> args = {
+            "latency_benchmark",
+            "--name",
+            "latencyBenchmarkModule",
+            "--runtime",
+            "simulated",
+            "--simulatedTimestamps",
+            "true",
+            "--simulatedDevices",
+            std::to_string(devices),
+            "--period",
+            std::to_string(period),
+            "--tfBaseFrameName",
+            BaseFrame,
+        };
+        std::vector<char*> argv;
+        for (auto& arg : args) {
+            argv.push_back(arg.data());
+        }
+
+        yarp::os::ResourceFinder rf;
+        rf.configure(static_cast<int>(argv.size()), argv.data());
+
+        OpenVRTrackersModule module;
+        if (module.runModuleThreaded(rf) != 0) {
+            yError() << "Failed to start the module";
+            return false;
+        }
+        const ModuleStopper stopper{module};
+
+        Probe probe;
+        std::atomic<bool> stop{false};
+        std::thread poller;
+
+        yarp::os::BufferedPort<yarp::os::Bottle> port;
+        StreamProbe streamProbe(probe);
+        yarp::dev::PolyDriver client;
+
+        if (mode == "stream") {
+            port.useCallback(streamProbe);
+            if (!port.open(Prefix + "/transforms:i")
+                || !yarp::os::Network::connect("/transformServer/transforms:o",
+                                               port.getName())) {
+                yError() << "Failed to connect to the transformServer";
+                return false;
+            }
+        }
+        else {
+            yarp::os::Property cfg;
+            cfg.put("device", "frameTransformClient");
+            cfg.put("filexml_option", "ftc_yarp_only.xml");
+            cfg.put("ft_client_prefix", Prefix + "/tf");
+            cfg.put("local_rpc", Prefix + "/tf/local_rpc");
+
+            yarp::dev::IFrameTransform* tf = nullptr;
+            if (!(client.open(cfg) && client.view(tf) && tf)) {
+                yError() << "Failed to open the frameTransformClient";
+                return false;
+            }
+
+            poller = std::thread([&, tf] {
+                yarp::sig::Matrix transform(4, 4);
+                while (!stop) {
+                    for (size_t i = 1; i <= devices; ++i) {
+                        const std::string frame =
+                            FramePrefix + std::to_string(i);
+                        if (tf->getTransform(frame, BaseFrame, transform)) {
+                            probe.record(frame, transform[0][3]);
+                        }
+                    }
+                    yarp::os::Time::delay(period);
+                }
+            });
+        }
+
+        yarp::os::Time::delay(Warmup);
+        probe.startRecording();
+        yarp::os::Time::delay(duration);
+        result.ages = probe.ages();
+
+        stop = true;
+        if (poller.joinable()) {
+            poller.join();
+        }
+        port.close();
+        client.close();
+        return true;
+    }
+} // namespace latency_benchmark
+
+int main(int argc, char** argv)
+{
+    yarp::os::Network yarp;
+
+    // Ports and name server are local to this process
+    yarp::os::Network::setLocalMode(true);
+
+    yarp::os::ResourceFinder rf;
+    rf.configure(argc, argv);
+
+    const yarp::os::Bottle devices =
+        latency_benchmark::ListOption(rf, "devices", "1 4 16");
+    const yarp::os::Bottle periods =
+        latency_benchmark::ListOption(rf, "periods", "0.01 0.005 0.002");
+    const yarp::os::Bottle modes =
+        latency_benchmark::ListOption(rf, "modes", "stream poll");
+    const double duration =
+        rf.check("duration", yarp::os::Value(5.0)).asFloat64();
+    const double serverPeriod =
+        rf.check("serverPeriod", yarp::os::Value(0.01)).asFloat64();
+
+    // Start the transform server
+    yarp::os::Property serverCfg;
+    serverCfg.fromString("(device transformServer) "
+                         "(ROS (enable_ros_publisher 0) "
+                         "(enable_ros_subscriber 0))");
+    serverCfg.put("period", serverPeriod);
+
+    yarp::dev::PolyDriver server;
+    if (!server.open(serverCfg)) {
+        yError() << "Failed to open the transformServer";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<latency_benchmark::Result> results;
+    for (size_t d = 0; d < devices.size(); ++d) {
+        for (size_t p = 0; p < periods.size(); ++p) {
+            for (size_t m = 0; m < modes.size(); ++m) {
+                const std::string mode = modes.get(m).asString();
+                if (mode != "stream" && mode != "poll") {
+                    yError() << "Invalid mode" << mode;
+                    return EXIT_FAILURE;
+                }
+
+                latency_benchmark::Result result;
+                if (!latency_benchmark::Run(
+                        static_cast<size_t>(devices.get(d).asInt32()),
+                        periods.get(p).asFloat64(),
+                        mode,
+                        duration,
+                        result)) {
+                    return EXIT_FAILURE;
+                }
+                results.push_back(std::move(result));
+            }
+        }
+    }
+
+    server.close();
+
+    // Report
+    std::cout << std::endl
+              << "devices  period[s]  mode    samples   p50[ms]   p90[ms]"
+              << "   p99[ms]   max[ms]" << std::endl;
+
+    for (const auto& result : results) {
+        const auto& ages = result.ages;
+        const double max =
+            ages.empty() ? 0.0 : *std::max_element(ages.begin(), ages.end());
+
+        std::cout << std::setw(7) << result.devices << std::setw(11)
+                  << std::fixed << std::setprecision(3) << result.period
+                  << "  " << std::left << std::setw(6) << result.mode
+                  << std::right << std::setw(9) << ages.size()
+                  << std::setw(10) << latency_benchmark::Percentile(ages, 0.5)
+                  << std::setw(10) << latency_benchmark::Percentile(ages, 0.9)
+                  << std::setw(10) << latency_benchmark::Percentile(ages, 0.99)
+                  << std::setw(10) << max << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+// Unit test of the PoseUpsampler: extrapolation with the velocities of the
+// samples, decay of the continuity correction, and extrapolation error.
+
+#include "PoseUpsampler.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+    constexpr double Pi = 3.14159265358979323846;
+
+    int failures = 0;
+
+    void Check(const bool condition, const std::string& what)
+    {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << std::endl;
+            failures++;
+        }
+    }
+
+    bool Near(const double a, const double b, const double tolerance = 1e-9)
+    {
+        return std::abs(a - b) <= tolerance;
+    }
+
+    // Rotation of the given angle about z
+    openvr::Pose MakePose(const std::array<double, 3>& position,
+                          const double yaw)
+    {
+        openvr::Pose pose{};
+        pose.position = position;
+        pose.quaternion = {std::cos(0.5 * yaw), 0.0, 0.0, std::sin(0.5 * yaw)};
+        pose.rotationRowMajor = {std::cos(yaw),
+                                 -std::sin(yaw),
+                                 0.0,
+                                 std::sin(yaw),
+                                 std::cos(yaw),
+                                 0.0,
+                                 0.0,
+                                 0.0,
+                                 1.0};
+        return pose;
+    }
+
+    double Yaw(const openvr::Pose& pose)
+    {
+        return 2.0 * std::atan2(pose.quaternion[3], pose.quaternion[0]);
+    }
+
+    void TestExtrapolation()
+    {
+        openvr::UpsamplingOptions options;
+        options.maxExtrapolation = 0.05;
+        openvr::PoseUpsampler upsampler(options);
+
+        openvr::Pose pose = MakePose({1.0, 2.0, 3.0}, 0.0);
+        pose.linearVelocity = {1.0, -2.0, 0.5};
+        pose.angularVelocity = {0.0, 0.0, Pi};
+        Check(upsampler.push("A", 10.0, pose), "first sample accepted");
+        Check(!upsampler.push("A", 10.01, pose), "repeated sample ignored");
+        Check(!upsampler.sample("B", 10.0), "unknown device");
+
+        const auto at = upsampler.sample("A", 10.02);
+        Check(at.has_value(), "sample of a known device");
+        Check(Near(at->position[0], 1.02) && Near(at->position[1], 1.96)
+                  && Near(at->position[2], 3.01),
+              "position extrapolated with the linear velocity");
+        Check(Near(Yaw(at.value()), 0.02 * Pi),
+              "orientation extrapolated with the angular velocity");
+        Check(Near(at->rotationRowMajor[3], std::sin(0.02 * Pi)),
+              "rotation matrix consistent with the quaternion");
+
+        const auto late = upsampler.sample("A", 11.0);
+        Check(Near(late->position[0], 1.05)
+                  && Near(Yaw(late.value()), 0.05 * Pi),
+              "extrapolation capped to the maximum");
+
+        const auto early = upsampler.sample("A", 9.0);
+        Check(Near(early->position[0], 1.0), "no extrapolation backwards");
+
+        upsampler.remove("A");
+        Check(!upsampler.sample("A", 10.0), "device removed");
+    }
+
+    void TestCorrectionDecay()
+    {
+        openvr::UpsamplingOptions options;
+        options.maxExtrapolation = 0.05;
+        options.correctionTime = 0.01;
+        openvr::PoseUpsampler upsampler(options);
+
+        openvr::Pose first = MakePose({0.0, 0.0, 0.0}, 0.0);
+        first.linearVelocity = {1.0, 0.0, 0.0};
+        upsampler.push("A", 0.0, first);
+
+        // The new sample is 2 cm and 0.1 rad away from the extrapolation
+        openvr::Pose second = MakePose({0.031, 0.0, 0.0}, 0.1);
+        second.linearVelocity = {1.0, 0.0, 0.0};
+        const double before = upsampler.sample("A", 0.011)->position[0];
+        upsampler.push("A", 0.011, second);
+
+        const auto start = upsampler.sample("A", 0.011);
+        Check(Near(start->position[0], before) && Near(Yaw(start.value()), 0.0),
+              "no step when the new sample arrives");
+
+        const auto half = upsampler.sample("A", 0.016);
+        Check(Near(half->position[0], 0.036 - 0.01),
+              "half of the position correction after half of the time");
+        Check(Near(Yaw(half.value()), 0.05),
+              "half of the rotation correction after half of the time");
+
+        const auto end = upsampler.sample("A", 0.021);
+        Check(Near(end->position[0], 0.041) && Near(Yaw(end.value()), 0.1),
+              "new sample followed after the correction time");
+    }
+
+    void TestCorrectionTimeChange()
+    {
+        openvr::UpsamplingOptions options;
+        options.maxExtrapolation = 0.05;
+        options.correctionTime = 0.01;
+        openvr::PoseUpsampler upsampler(options);
+
+        upsampler.push("A", 0.0, MakePose({0.0, 0.0, 0.0}, 0.0));
+        upsampler.push("A", 0.01, MakePose({0.02, 0.0, 0.0}, 0.0));
+
+        // The correction in progress follows the new correction time
+        upsampler.setCorrectionTime(0.02);
+        const auto half = upsampler.sample("A", 0.02);
+        Check(Near(half->position[0], 0.01),
+              "half of the correction after half of the new time");
+    }
+
+    void TestError()
+    {
+        openvr::UpsamplingOptions options;
+        options.maxExtrapolation = 0.05;
+        openvr::PoseUpsampler upsampler(options);
+
+        openvr::Pose pose = MakePose({0.0, 0.0, 0.0}, 0.0);
+        pose.linearVelocity = {0.0, 1.0, 0.0};
+        upsampler.push("A", 0.0, pose);
+        Check(upsampler.error().samples == 0, "no error from the first sample");
+
+        // Predicted (0, 0.01, 0), received 3 cm and 0.2 rad away
+        openvr::Pose off = MakePose({0.0, 0.01, 0.03}, 0.2);
+        off.linearVelocity = {0.0, 1.0, 0.0};
+        upsampler.push("A", 0.01, off);
+
+        auto error = upsampler.error();
+        Check(error.samples == 1, "one error sample");
+        Check(Near(error.position, 0.03) && Near(error.maxPosition, 0.03),
+              "position error of the first prediction");
+        Check(Near(error.orientation, 0.2) && Near(error.maxOrientation, 0.2),
+              "orientation error of the first prediction");
+
+        // Exactly predicted: the smoothed error decreases, the maximum stays
+        openvr::Pose exact = off;
+        exact.position[1] += 0.01;
+        upsampler.push("A", 0.02, exact);
+
+        error = upsampler.error();
+        Check(error.samples == 2, "two error samples");
+        Check(Near(error.position, 0.95 * 0.03)
+                  && Near(error.maxPosition, 0.03),
+              "smoothed position error");
+        Check(Near(error.orientation, 0.95 * 0.2)
+                  && Near(error.maxOrientation, 0.2),
+              "smoothed orientation error");
+
+        // A sample after a gap restarts the device without an error
+        upsampler.push("A", 1.0, MakePose({5.0, 5.0, 5.0}, 1.0));
+        Check(upsampler.error().samples == 2, "no error after a gap");
+        const auto restarted = upsampler.sample("A", 1.0);
+        Check(Near(restarted->position[0], 5.0)
+                  && Near(Yaw(restarted.value()), 1.0),
+              "no correction after a gap");
+    }
+} // namespace
+
+int main()
+{
+    TestExtrapolation();
+    TestCorrectionDecay();
+    TestCorrectionTimeChange();
+    TestError();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+// Stress test of the DevicesManager driven by a simulated runtime.
+//
+// A storm thread connects and disconnects devices as fast as possible
+// (ending with a Quit event), while a publisher thread computes the poses
+// at 1 kHz and several reader threads hammer the per-device accessors.
+// The latency of the calls is reported, and the test fails if the
+// configured thresholds are exceeded or if a thread stops making progress.
+
+#include "OpenVRTrackersDriver.h"
+#include "SimulatedRuntime.h"
+
+#include <yarp/os/Log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        double duration = 10.0;
+        size_t readers = 4;
+        size_t devices = 16;
+        long callLatencyUs = 20;
+        double eventsPeriod = 0.001;
+        double maxP99Us = 20000.0;
+        double maxUs = 200000.0;
+        double deadlockTimeout = 5.0;
+    };
+
+    // Latency samples of one kind of call, in microseconds
+    struct Latencies
+    {
+        std::vector<double> samples;
+
+        void merge(const Latencies& other)
+        {
+            samples.insert(
+                samples.end(), other.samples.begin(), other.samples.end());
+        }
+
+        double percentile(const double p)
+        {
+            if (samples.empty()) {
+                return 0.0;
+            }
+            const auto nth = samples.begin()
+                             + static_cast<long>(p * (samples.size() - 1));
+            std::nth_element(samples.begin(), nth, samples.end());
+            return *nth;
+        }
+
+        double max() const
+        {
+            return samples.empty()
+                       ? 0.0
+                       : *std::max_element(samples.begin(), samples.end());
+        }
+    };
+
+    template <typename F>
+    void Measure(Latencies& latencies, F&& call)
+    {
+        const auto start = Clock::now();
+        call();
+        latencies.samples.push_back(
+            std::chrono::duration<double, std::micro>(Clock::now() - start)
+                .count());
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+            const double value = std::atof(argv[++i]);
+
+            if (arg == "--duration") {
+                options.duration = value;
+            }
+            else if (arg == "--readers") {
+                options.readers = static_cast<size_t>(value);
+            }
+            else if (arg == "--devices") {
+                options.devices = static_cast<size_t>(value);
+            }
+            else if (arg == "--callLatencyUs") {
+                options.callLatencyUs = static_cast<long>(value);
+            }
+            else if (arg == "--eventsPeriod") {
+                options.eventsPeriod = value;
+            }
+            else if (arg == "--maxP99Us") {
+                options.maxP99Us = value;
+            }
+            else if (arg == "--maxUs") {
+                options.maxUs = value;
+            }
+            else if (arg == "--deadlockTimeout") {
+                options.deadlockTimeout = value;
+            }
+            else {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::cerr << "Usage: stress_driver [--duration s] [--readers n] "
+                  << "[--devices n] [--callLatencyUs us] [--eventsPeriod s] "
+                  << "[--maxP99Us us] [--maxUs us] [--deadlockTimeout s]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // The storm makes the driver log every device change
+    yarp::os::Log::setMinimumPrintLevel(yarp::os::Log::ErrorType);
+
+    // =========================
+    // Runtime and manager setup
+    // =========================
+
+    auto runtimeOwner = std::make_unique<openvr::SimulatedRuntime>();
+    openvr::SimulatedRuntime& runtime = *runtimeOwner;
+    runtime.setCallLatency(std::chrono::microseconds(options.callLatencyUs));
+
+    // The HMD is always connected, the other devices will be toggled
+    runtime.connectDevice(0, "SIM-HMD", vr::TrackedDeviceClass_HMD);
+    for (size_t i = 1; i <= options.devices; ++i) {
+        runtime.connectDevice(static_cast<vr::TrackedDeviceIndex_t>(i),
+                              "SIM-" + std::to_string(i));
+    }
+
+    auto manager =
+        std::make_unique<openvr::DevicesManager>(std::move(runtimeOwner));
+    manager->setEventsPeriod(options.eventsPeriod);
+
+    if (!manager->initialize()) {
+        std::cerr << "Failed to initialize the manager" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // =======
+    // Threads
+    // =======
+
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> events{0};
+
+    // One progress counter per thread, checked by the watchdog
+    const size_t nThreads = options.readers + 2;
+    std::vector<std::atomic<uint64_t>> progress(nThreads);
+
+    std::mutex resultsMutex;
+    Latencies computeLatencies;
+    Latencies poseLatencies;
+    Latencies lockLatencies;
+
+    std::vector<std::thread> threads;
+
+    // Connect and disconnect random devices
+    threads.emplace_back([&, id = 0] {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<size_t> index(1, options.devices);
+
+        while (!stop) {
+            const auto i = static_cast<vr::TrackedDeviceIndex_t>(
+                index(generator));
+
+            if (runtime.isTrackedDeviceConnected(i)) {
+                runtime.disconnectDevice(i);
+            }
+            else {
+                runtime.connectDevice(i, "SIM-" + std::to_string(i));
+            }
+
+            events++;
+            progress[id]++;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    // Compute the poses like the module loop
+    threads.emplace_back([&, id = 1] {
+        Latencies latencies;
+
+        while (!stop) {
+            Measure(latencies, [&] { manager->computePoses(); });
+            progress[id]++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        const auto lock = std::unique_lock(resultsMutex);
+        computeLatencies.merge(latencies);
+    });
+
+    // Read the devices from multiple threads
+    for (size_t r = 0; r < options.readers; ++r) {
+        threads.emplace_back([&, id = r + 2] {
+            Latencies pose;
+            Latencies lock;
+
+            while (!stop) {
+                for (const auto& sn : manager->managedDevices()) {
+                    Measure(pose, [&] { manager->pose(sn); });
+
+                    // The type accessor only takes the lock and looks up the
+                    // device, its latency is dominated by the lock wait
+                    Measure(lock, [&] { manager->type(sn); });
+                }
+                progress[id]++;
+                std::this_thread::yield();
+            }
+
+            const auto resultsLock = std::unique_lock(resultsMutex);
+            poseLatencies.merge(pose);
+            lockLatencies.merge(lock);
+        });
+    }
+
+    // ========
+    // Watchdog
+    // ========
+
+    // Detect threads that stop making progress. A deadlocked process
+    // cannot be joined, therefore it is terminated immediately.
+    auto watch = [&](const Clock::time_point end, const bool checkProgress) {
+        std::vector<uint64_t> last(nThreads, 0);
+        auto lastProgress = Clock::now();
+
+        while (Clock::now() < end) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+            bool advanced = true;
+            for (size_t i = 0; i < nThreads && checkProgress; ++i) {
+                advanced = advanced && progress[i] != last[i];
+                last[i] = progress[i];
+            }
+
+            if (advanced) {
+                lastProgress = Clock::now();
+            }
+            else if (Clock::now() - lastProgress
+                     > std::chrono::duration<double>(options.deadlockTimeout)) {
+                std::cerr << "FAILED: a thread did not make progress for "
+                          << options.deadlockTimeout << " s (deadlock?)"
+                          << std::endl;
+                std::_Exit(EXIT_FAILURE);
+            }
+        }
+    };
+
+    std::cout << "Running the event storm for " << options.duration << " s with "
+              << options.readers << " readers and " << options.devices
+              << " devices" << std::endl;
+
+    watch(Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                             std::chrono::duration<double>(options.duration)),
+          true);
+
+    // Quit the runtime while the readers are still running
+    runtime.quit();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    stop = true;
+
+    // Joining and destroying the manager must not hang either
+    std::atomic<bool> terminated{false};
+    std::thread teardown([&] {
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        manager.reset();
+        terminated = true;
+    });
+
+    const auto teardownEnd =
+        Clock::now()
+        + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(options.deadlockTimeout));
+    while (!terminated) {
+        if (Clock::now() > teardownEnd) {
+            std::cerr << "FAILED: the teardown did not complete in "
+                      << options.deadlockTimeout << " s (deadlock?)"
+                      << std::endl;
+            std::_Exit(EXIT_FAILURE);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    teardown.join();
+
+    // ======
+    // Report
+    // ======
+
+    bool failed = false;
+
+    auto report = [&](const std::string& name, Latencies& latencies) {
+        const double p50 = latencies.percentile(0.50);
+        const double p99 = latencies.percentile(0.99);
+        const double max = latencies.max();
+
+        std::cout << std::left << std::setw(16) << name << std::right
+                  << " calls " << std::setw(9) << latencies.samples.size()
+                  << "  p50 " << std::setw(9) << std::fixed
+                  << std::setprecision(1) << p50 << " us"
+                  << "  p99 " << std::setw(9) << p99 << " us"
+                  << "  max " << std::setw(9) << max << " us" << std::endl;
+
+        if (p99 > options.maxP99Us || max > options.maxUs) {
+            std::cerr << "FAILED: " << name << " latency above the threshold "
+                      << "(p99 " << options.maxP99Us << " us, max "
+                      << options.maxUs << " us)" << std::endl;
+            failed = true;
+        }
+    };
+
+    std::cout << "Events: " << events << std::endl;
+    report("computePoses", computeLatencies);
+    report("pose", poseLatencies);
+    report("lock wait", lockLatencies);
+
+    if (failed) {
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "PASSED" << std::endl;
+    return EXIT_SUCCESS;
+}
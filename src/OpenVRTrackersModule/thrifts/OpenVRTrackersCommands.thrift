@@ -6,6 +6,66 @@
  * BSD-2-Clause license. See the accompanying LICENSE file for details.
  */
 
+struct DeviceInfo
+{
+    /** Serial number of the device. */
+    1: string serialNumber;
+    /** Type of the device (HMD, Controller, GenericTracker). */
+    2: string type;
+    /** Name of the frame published on the transform server. */
+    3: string frameName;
+}
+
+struct DevicePose
+{
+    /** Serial number of the device. */
+    1: string serialNumber;
+    /** Name of the frame published on the transform server. */
+    2: string frameName;
+    /** Time in seconds at which the pose was sampled. */
+    3: double timestamp;
+    /** False if the runtime did not provide a valid pose in this sample. */
+    4: bool valid;
+    /** Position [x, y, z] in meters. */
+    5: list<double> position;
+    /** Orientation quaternion [w, x, y, z]. */
+    6: list<double> quaternion;
+}
+
+struct ModuleStats
+{
+    /** Number of cycles executed since the start of the module. */
+    1: i64 cycles;
+    /** Configured period in seconds. */
+    2: double period;
+    /** Smoothed period measured between consecutive cycles. */
+    3: double measuredPeriod;
+    /** Number of configuration changes applied at runtime. */
+    4: i32 configurationChanges;
+    /** Description of the last applied configuration change. */
+    5: string lastConfigurationChange;
+    /** Time at which the last configuration change was applied. */
+    6: double lastConfigurationChangeTime;
+    /** Number of haptic pulses issued to the runtime. */
+    7: i64 hapticPulses;
+    /** Number of haptic commands merged with another one to the same axis. */
+    8: i64 hapticCoalesced;
+    /** Number of haptic commands that were malformed or whose target device was not found. */
+    9: i64 hapticRejected;
+    /** Smoothed time in seconds from a haptic command to its pulse. */
+    10: double hapticLatency;
+    /** Maximum time in seconds from a haptic command to its pulse. */
+    11: double hapticMaxLatency;
+    /** Smoothed distance in meters between the extrapolated and the new samples. */
+    12: double extrapolationPositionError;
+    /** Maximum distance in meters between the extrapolated and the new samples. */
+    13: double extrapolationMaxPositionError;
+    /** Smoothed angle in radians between the extrapolated and the new samples. */
+    14: double extrapolationOrientationError;
+    /** Maximum angle in radians between the extrapolated and the new samples. */
+    15: double extrapolationMaxOrientationError;
+}
+
 service OpenVRTrackersCommands
 {
     /**
@@ -13,4 +73,75 @@ service OpenVRTrackersCommands
      * @return true if the reset was successful.
      */
     bool resetSeatedPosition();
+
+    /**
+     * Lists the devices managed in the latest sample.
+     * @return the information of the devices.
+     */
+    list<DeviceInfo> listDevices();
+
+    /**
+     * Gets the poses of all the devices from the latest sample.
+     * The runtime is not queried, all the poses belong to the same cycle.
+     * @return the poses of all the devices.
+     */
+    list<DevicePose> getAllPoses();
+
+    /**
+     * Gets the valid poses of a device received in the last seconds.
+     * @param serial the serial number of the device.
+     * @param seconds the length of the time window, bounded by historyDuration.
+     * @return the poses ordered by increasing timestamp.
+     */
+    list<DevicePose> getHistory(1: string serial, 2: double seconds);
+
+    /**
+     * Sets the period of the module. The change and all the following ones
+     * are applied together at the beginning of the next cycle.
+     * @param period the new period in seconds.
+     * @return true if the value is valid.
+     */
+    bool setPeriod(1: double period);
+
+    /**
+     * Sets the tracking universe origin (seated, standing or raw).
+     * @param origin the name of the origin, case insensitive.
+     * @return true if the value is valid.
+     */
+    bool setVrOrigin(1: string origin);
+
+    /**
+     * Sets the name of the frame the poses are expressed in.
+     * @param name the name of the base frame.
+     * @return true if the value is valid.
+     */
+    bool setBaseFrameName(1: string name);
+
+    /**
+     * Sets the axes convention of the poses (openvr, ros or robot).
+     * @param convention the name of the convention, case insensitive.
+     * @return true if the value is valid.
+     */
+    bool setOutputConvention(1: string convention);
+
+    /**
+     * Sets how far in the future the runtime predicts the poses.
+     * @param seconds the prediction time, in [0, 0.1] seconds.
+     * @return true if the value is valid.
+     */
+    bool setPredictionTime(1: double seconds);
+
+    /**
+     * Enables or disables the processing of the poses.
+     * @param orthonormalize project the rotations onto SO(3).
+     * @param quaternionContinuity avoid quaternion sign flips between samples.
+     * @return true if the request was accepted.
+     */
+    bool setPoseProcessing(1: bool orthonormalize, 2: bool quaternionContinuity);
+
+    /**
+     * Gets the statistics of the module, including the configuration changes.
+     * @return the statistics.
+     */
+    ModuleStats getStats();
 }
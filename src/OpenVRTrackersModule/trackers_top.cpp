@@ -0,0 +1,444 @@
+/*
+ * Copyright (C) 2025 Fondazione Istituto Italiano di Tecnologia
+ *
+ * Licensed under either the GNU Lesser General Public License v3.0 :
+ * https://www.gnu.org/licenses/lgpl-3.0.html
+ * or the GNU Lesser General Public License v2.1 :
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.html
+ * at your option.
+ */
+
+// Live diagnostic of the tracked devices, in the style of top.
+//
+// A sampler thread computes the poses as fast as configured and records,
+// for every device, whether the pose was usable and when it changed. The
+// main thread refreshes a table in place with the statistics of a sliding
+// window:
+//
+// - rate:   number of pose changes per second, i.e. the effective update
+//           rate of the device independently of the sampling rate
+// - jitter: standard deviation of the intervals between pose changes
+// - valid:  percentage of samples with a usable pose
+// - noise:  position noise estimated from the second differences of
+//           consecutive poses, that cancel smooth motion. For white noise
+//           of standard deviation s on each axis and regular updates,
+//           E[|p2 - 2 p1 + p0|^2] is 18 s^2.
+// - since:  time elapsed since the last pose change
+
+#include "OpenVRTrackersDriver.h"
+#include "SimulatedRuntime.h"
+
+#include <yarp/os/Log.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<bool> Interrupted{false};
+
+    struct Options
+    {
+        std::string runtime = "openvr";
+        long devices = 3;
+        double samplePeriod = 0.001;
+        double refreshRate = 4.0;
+        double window = 2.0;
+        double duration = 0.0;
+    };
+
+    struct Sample
+    {
+        Clock::time_point time;
+        bool usable;
+    };
+
+    struct Change
+    {
+        Clock::time_point time;
+        std::array<double, 3> position;
+    };
+
+    struct DeviceStats
+    {
+        openvr::TrackedDeviceType type = openvr::TrackedDeviceType::Invalid;
+        openvr::DeviceState state;
+        std::deque<Sample> samples;
+        std::deque<Change> changes;
+        std::optional<Clock::time_point> lastChange;
+
+        void prune(const Clock::time_point oldest)
+        {
+            while (!samples.empty() && samples.front().time < oldest) {
+                samples.pop_front();
+            }
+            while (!changes.empty() && changes.front().time < oldest) {
+                changes.pop_front();
+            }
+        }
+    };
+
+    std::string TrackingResultName(const openvr::TrackingResult result)
+    {
+        switch (result) {
+            case openvr::TrackingResult::Uninitialized:
+                return "uninitialized";
+            case openvr::TrackingResult::CalibratingInProgress:
+                return "calibrating";
+            case openvr::TrackingResult::CalibratingOutOfRange:
+                return "calib_out_of_range";
+            case openvr::TrackingResult::RunningOK:
+                return "running_ok";
+            case openvr::TrackingResult::RunningOutOfRange:
+                return "out_of_range";
+            case openvr::TrackingResult::FallbackRotationOnly:
+                return "rotation_only";
+        }
+        return "unknown";
+    }
+
+    std::string TypeName(const openvr::TrackedDeviceType type)
+    {
+        switch (type) {
+            case openvr::TrackedDeviceType::HMD:
+                return "hmd";
+            case openvr::TrackedDeviceType::Controller:
+                return "controller";
+            case openvr::TrackedDeviceType::GenericTracker:
+                return "tracker";
+            default:
+                return "other";
+        }
+    }
+
+    class Sampler
+    {
+    public:
+        Sampler(openvr::DevicesManager& manager, const Options& options)
+            : m_manager(manager)
+            , m_options(options)
+        {
+        }
+
+        void run(const std::atomic<bool>& stop)
+        {
+            const auto period =
+                std::chrono::duration<double>(m_options.samplePeriod);
+            auto next = Clock::now();
+
+            while (!stop) {
+                m_manager.computePoses();
+                const auto now = Clock::now();
+
+                for (const auto& serial : m_manager.managedDevices()) {
+                    sample(serial, now);
+                }
+
+                next += std::chrono::duration_cast<Clock::duration>(period);
+                if (next < now) {
+                    next = now;
+                }
+                std::this_thread::sleep_until(next);
+            }
+        }
+
+        std::string render()
+        {
+            const auto lock = std::unique_lock(m_mutex);
+            const auto now = Clock::now();
+
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(2) << std::left
+                << std::setw(20) << "serial" << std::setw(11) << "type"
+                << std::right << std::setw(9) << "rate[Hz]" << std::setw(11)
+                << "jitter[ms]" << std::setw(10) << "valid[%]" << "  "
+                << std::left << std::setw(19) << "tracking" << std::right
+                << std::setw(10) << "noise[mm]" << std::setw(10)
+                << "since[s]" << "\n";
+
+            for (auto& [serial, stats] : m_devices) {
+                stats.prune(now - window());
+                out << std::left << std::setw(20) << serial << std::setw(11)
+                    << TypeName(stats.type) << std::right;
+
+                const auto& changes = stats.changes;
+                const auto& samples = stats.samples;
+
+                // Rate and jitter of the intervals between changes
+                double rate = 0.0;
+                double jitter = 0.0;
+                if (changes.size() >= 2) {
+                    const double span = Seconds(changes.back().time
+                                                - changes.front().time);
+                    rate = (changes.size() - 1) / span;
+
+                    const double mean = span / (changes.size() - 1);
+                    double sum = 0.0;
+                    for (size_t i = 1; i < changes.size(); ++i) {
+                        const double dt =
+                            Seconds(changes[i].time - changes[i - 1].time);
+                        sum += (dt - mean) * (dt - mean);
+                    }
+                    jitter = 1e3 * std::sqrt(sum / (changes.size() - 1));
+                }
+
+                size_t usable = 0;
+                for (const auto& sample : samples) {
+                    usable += sample.usable ? 1 : 0;
+                }
+                const double valid =
+                    samples.empty() ? 0.0 : 100.0 * usable / samples.size();
+
+                double noise = 0.0;
+                if (changes.size() >= 3) {
+                    double sum = 0.0;
+                    for (size_t i = 2; i < changes.size(); ++i) {
+                        // Scale the previous step by the ratio of the
+                        // intervals, so that constant velocity cancels out
+                        // also with irregular updates
+                        const double ratio =
+                            Seconds(changes[i].time - changes[i - 1].time)
+                            / Seconds(changes[i - 1].time
+                                      - changes[i - 2].time);
+                        for (size_t k = 0; k < 3; ++k) {
+                            const double d =
+                                changes[i].position[k]
+                                - changes[i - 1].position[k]
+                                - ratio
+                                      * (changes[i - 1].position[k]
+                                         - changes[i - 2].position[k]);
+                            sum += d * d;
+                        }
+                    }
+                    noise = 1e3 * std::sqrt(sum / (18.0 * (changes.size() - 2)));
+                }
+
+                out << std::setw(9) << rate << std::setw(11) << jitter
+                    << std::setw(10) << valid << "  " << std::left
+                    << std::setw(19)
+                    << (stats.state.connected
+                            ? TrackingResultName(stats.state.trackingResult)
+                            : "disconnected")
+                    << std::right << std::setw(10) << noise;
+
+                if (stats.lastChange.has_value()) {
+                    out << std::setw(10)
+                        << Seconds(now - stats.lastChange.value());
+                }
+                else {
+                    out << std::setw(10) << "-";
+                }
+                out << "\n";
+            }
+
+            return out.str();
+        }
+
+    private:
+        openvr::DevicesManager& m_manager;
+        const Options& m_options;
+        std::map<std::string, DeviceStats> m_devices;
+        std::mutex m_mutex;
+
+        static double Seconds(const Clock::duration duration)
+        {
+            return std::chrono::duration<double>(duration).count();
+        }
+
+        Clock::duration window() const
+        {
+            return std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(m_options.window));
+        }
+
+        void sample(const std::string& serial, const Clock::time_point now)
+        {
+            const auto state = m_manager.state(serial);
+            if (!state.has_value()) {
+                return;
+            }
+
+            // The pose is read only when usable, pose() logs otherwise
+            const bool usable =
+                state->connected && state->poseIsValid
+                && state->trackingResult == openvr::TrackingResult::RunningOK;
+            std::optional<openvr::Pose> pose;
+            if (usable) {
+                pose = m_manager.pose(serial);
+            }
+
+            const auto type = m_manager.type(serial);
+
+            const auto lock = std::unique_lock(m_mutex);
+            DeviceStats& stats = m_devices[serial];
+            stats.type = type;
+            stats.state = state.value();
+            stats.samples.push_back({now, pose.has_value()});
+
+            if (pose.has_value()
+                && (stats.changes.empty()
+                    || stats.changes.back().position != pose->position)) {
+                stats.changes.push_back({now, pose->position});
+                stats.lastChange = now;
+            }
+
+            stats.prune(now - window());
+        }
+    };
+
+    // The whole argument must be a number
+    bool ParseNumber(const char* text, double& value)
+    {
+        char* end = nullptr;
+        value = std::strtod(text, &end);
+        return end != text && *end == '\0';
+    }
+
+    bool ParseInteger(const char* text, long& value)
+    {
+        char* end = nullptr;
+        value = std::strtol(text, &end, 10);
+        return end != text && *end == '\0';
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+
+            if (arg == "--runtime") {
+                options.runtime = argv[++i];
+                if (options.runtime != "openvr"
+                    && options.runtime != "simulated") {
+                    std::cerr << "Invalid runtime " << options.runtime
+                              << std::endl;
+                    return false;
+                }
+                continue;
+            }
+
+            const char* text = argv[++i];
+
+            if (arg == "--devices") {
+                if (!ParseInteger(text, options.devices)) {
+                    std::cerr << "Invalid value " << text << " for " << arg
+                              << std::endl;
+                    return false;
+                }
+                continue;
+            }
+
+            double value = 0.0;
+            if (!ParseNumber(text, value)) {
+                std::cerr << "Invalid value " << text << " for " << arg
+                          << std::endl;
+                return false;
+            }
+
+            if (arg == "--samplePeriod") {
+                options.samplePeriod = value;
+            }
+            else if (arg == "--refreshRate") {
+                options.refreshRate = value;
+            }
+            else if (arg == "--window") {
+                options.window = value;
+            }
+            else if (arg == "--duration") {
+                options.duration = value;
+            }
+            else {
+                std::cerr << "Unknown option " << arg << std::endl;
+                return false;
+            }
+        }
+
+        // The HMD takes the first index of the simulated runtime
+        return options.devices >= 0
+               && options.devices < long{vr::k_unMaxTrackedDeviceCount}
+               && options.samplePeriod > 0.0 && options.refreshRate > 0.0
+               && options.window > 0.0 && options.duration >= 0.0;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::cerr << "Usage: trackers_top [--runtime openvr|simulated] "
+                  << "[--devices n] [--samplePeriod s] [--refreshRate Hz] "
+                  << "[--window s] [--duration s]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Device changes are shown in the table, the log would scroll it
+    yarp::os::Log::setMinimumPrintLevel(yarp::os::Log::ErrorType);
+
+    std::unique_ptr<openvr::DevicesManager> manager;
+    if (options.runtime == "simulated") {
+        auto runtime = std::make_unique<openvr::SimulatedRuntime>();
+        runtime->connectDevice(0, "SIM-HMD", vr::TrackedDeviceClass_HMD);
+        for (long i = 1; i <= options.devices; ++i) {
+            runtime->connectDevice(static_cast<vr::TrackedDeviceIndex_t>(i),
+                                   "SIM-" + std::to_string(i));
+        }
+        manager = std::make_unique<openvr::DevicesManager>(std::move(runtime));
+    }
+    else {
+        manager = std::make_unique<openvr::DevicesManager>();
+    }
+
+    if (!manager->initialize(openvr::TrackingUniverseOrigin::Standing)) {
+        std::cerr << "Failed to initialize the manager" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::signal(SIGINT, [](int) { Interrupted = true; });
+
+    Sampler sampler(*manager, options);
+    std::atomic<bool> stop{false};
+    std::thread samplerThread([&] { sampler.run(stop); });
+
+    const auto refreshPeriod = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / options.refreshRate));
+    const auto start = Clock::now();
+    auto next = start;
+
+    while (!Interrupted) {
+        next += refreshPeriod;
+        std::this_thread::sleep_until(next);
+
+        // Move the cursor home and clear the screen before redrawing
+        std::cout << "\033[H\033[J" << sampler.render() << std::flush;
+
+        if (options.duration > 0.0
+            && Clock::now() - start
+                   >= std::chrono::duration<double>(options.duration)) {
+            break;
+        }
+    }
+
+    stop = true;
+    samplerThread.join();
+
+    return EXIT_SUCCESS;
+}